@@ -9,7 +9,11 @@
 #include <stdio.h>
 #include <time.h>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <limits>
 #include <math.h>
 
 #include "lunar.h"
@@ -48,27 +52,27 @@ static int32_t solarMonth[] = {31,28,31,30,31,30,31,31,30,31,30,31};
 /**
  *  天干地支之天干速查表
  */
-static std::string Gan[] = {"\u7532","\u4e59","\u4e19","\u4e01","\u620a","\u5df1","\u5e9a","\u8f9b","\u58ec","\u7678"};
+static constexpr std::string_view Gan[] = {"\u7532","\u4e59","\u4e19","\u4e01","\u620a","\u5df1","\u5e9a","\u8f9b","\u58ec","\u7678"};
 
 /**
  *  天干地支之地支速查表
  */
-static std::string Zhi[] = {"\u5b50","\u4e11","\u5bc5","\u536f","\u8fb0","\u5df3","\u5348","\u672a","\u7533","\u9149","\u620c","\u4ea5"};
+static constexpr std::string_view Zhi[] = {"\u5b50","\u4e11","\u5bc5","\u536f","\u8fb0","\u5df3","\u5348","\u672a","\u7533","\u9149","\u620c","\u4ea5"};
 
 /**
  *  天干地支之地支速查表<=>生肖
  */
-static std::string Animals[] = {"\u9f20","\u725b","\u864e","\u5154","\u9f99","\u86c7","\u9a6c","\u7f8a","\u7334","\u9e21","\u72d7","\u732a"};
+static constexpr std::string_view Animals[] = {"\u9f20","\u725b","\u864e","\u5154","\u9f99","\u86c7","\u9a6c","\u7f8a","\u7334","\u9e21","\u72d7","\u732a"};
 
 /**
  *  24节气速查表
  */
-static std::string solarTerm[] = {"\u5c0f\u5bd2","\u5927\u5bd2","\u7acb\u6625","\u96e8\u6c34","\u60ca\u86f0","\u6625\u5206","\u6e05\u660e","\u8c37\u96e8","\u7acb\u590f","\u5c0f\u6ee1","\u8292\u79cd","\u590f\u81f3","\u5c0f\u6691","\u5927\u6691","\u7acb\u79cb","\u5904\u6691","\u767d\u9732","\u79cb\u5206","\u5bd2\u9732","\u971c\u964d","\u7acb\u51ac","\u5c0f\u96ea","\u5927\u96ea","\u51ac\u81f3"};
+static constexpr std::string_view solarTerm[] = {"\u5c0f\u5bd2","\u5927\u5bd2","\u7acb\u6625","\u96e8\u6c34","\u60ca\u86f0","\u6625\u5206","\u6e05\u660e","\u8c37\u96e8","\u7acb\u590f","\u5c0f\u6ee1","\u8292\u79cd","\u590f\u81f3","\u5c0f\u6691","\u5927\u6691","\u7acb\u79cb","\u5904\u6691","\u767d\u9732","\u79cb\u5206","\u5bd2\u9732","\u971c\u964d","\u7acb\u51ac","\u5c0f\u96ea","\u5927\u96ea","\u51ac\u81f3"};
 
 /**
  *  1900-2100各年的24节气日期速查表
  */
-static std::string sTermInfo[] = {"9778397bd097c36b0b6fc9274c91aa","97b6b97bd19801ec9210c965cc920e","97bcf97c3598082c95f8c965cc920f",
+static constexpr const char* sTermInfo[] = {"9778397bd097c36b0b6fc9274c91aa","97b6b97bd19801ec9210c965cc920e","97bcf97c3598082c95f8c965cc920f",
 				"97bd0b06bdb0722c965ce1cfcc920f","b027097bd097c36b0b6fc9274c91aa","97b6b97bd19801ec9210c965cc920e",
 				"97bcf97c359801ec95f8c965cc920f","97bd0b06bdb0722c965ce1cfcc920f","b027097bd097c36b0b6fc9274c91aa",
 				"97b6b97bd19801ec9210c965cc920e","97bcf97c359801ec95f8c965cc920f",	"97bd0b06bdb0722c965ce1cfcc920f",
@@ -136,20 +140,186 @@ static std::string sTermInfo[] = {"9778397bd097c36b0b6fc9274c91aa","97b6b97bd198
 				"7f07e7f0e47f531b0723b0b6fb0721","7f0e26665b66a449801e9808297c35",	"665f67f0e37f1489801eb072297c35",
 				"7ec967f0e37f14998082b0787b06bd","7f07e7f0e47f531b0723b0b6fb0721",	"7f0e27f1487f531b0b0bb0b6fb0722"};
 
+/**
+ *  sTermInfo 解码后的 1900-2100 各年 24 节气日期表，编译期展开
+ *  每 5 位十六进制数的十进制六位依次为四个节气的日期（1、2、1、2 位）
+ */
+static constexpr std::array< std::array< uint8_t, 24 >, 201 > sTermDays = [] {
+    std::array< std::array< uint8_t, 24 >, 201 > t{};
+    
+    for ( int32_t year = 0; year < 201; year++ )
+    {
+        for ( int32_t i = 0; i < 6; i++ )
+        {
+            int32_t value = 0;
+            for ( int32_t k = 0; k < 5; k++ )
+            {
+                char c = sTermInfo[ year ][ i * 5 + k ];
+                value = value * 16 + ( c <= '9' ? c - '0' : c - 'a' + 10 );
+            }
+            
+            t[ year ][ i * 4 ]     = value / 100000;
+            t[ year ][ i * 4 + 1 ] = value / 1000 % 100;
+            t[ year ][ i * 4 + 2 ] = value / 100 % 10;
+            t[ year ][ i * 4 + 3 ] = value % 100;
+        }
+    }
+    return t;
+}();
+
 /**
  *  数字转中文速查表
  */
-static std::string nStr1[] = {"\u65e5","\u4e00","\u4e8c","\u4e09","\u56db","\u4e94","\u516d","\u4e03","\u516b","\u4e5d","\u5341"};
+static constexpr std::string_view nStr1[] = {"\u65e5","\u4e00","\u4e8c","\u4e09","\u56db","\u4e94","\u516d","\u4e03","\u516b","\u4e5d","\u5341"};
 
 /**
  *  日期转农历称呼速查表
  */
-static std::string nStr2[] = {"\u521d","\u5341","\u5eff","\u5345"};
+static constexpr std::string_view nStr2[] = {"\u521d","\u5341","\u5eff","\u5345"};
 
 /**
  *  月份转农历称呼速查表
  */
-static std::string nStr3[] = {"\u6b63","\u4e8c","\u4e09","\u56db","\u4e94","\u516d","\u4e03","\u516b","\u4e5d","\u5341","\u51ac","\u814a"};
+static constexpr std::string_view nStr3[] = {"\u6b63","\u4e8c","\u4e09","\u56db","\u4e94","\u516d","\u4e03","\u516b","\u4e5d","\u5341","\u51ac","\u814a"};
+
+/**
+ *  编译期拼接的名称，最长 15 字节
+ */
+struct NameSlot {
+    char data[ 15 ];
+    uint8_t size;
+    
+    constexpr std::string_view view() const { return std::string_view( data, size ); }
+};
+
+static constexpr NameSlot joinName( std::initializer_list< std::string_view > parts )
+{
+    NameSlot slot{};
+    for ( std::string_view part : parts )
+    {
+        for ( char c : part )
+        {
+            slot.data[ slot.size++ ] = c;
+        }
+    }
+    return slot;
+}
+
+/**
+ *  六十甲子名称表
+ */
+static constexpr std::array< NameSlot, 60 > ganzhiNames = [] {
+    std::array< NameSlot, 60 > t{};
+    for ( int32_t i = 0; i < 60; i++ )
+    {
+        t[ i ] = joinName( { Gan[ i % 10 ], Zhi[ i % 12 ] } );
+    }
+    return t;
+}();
+
+/**
+ *  农历月名称表，前 12 项为平月，后 12 项为闰月
+ */
+static constexpr std::array< NameSlot, 24 > monthNames = [] {
+    std::array< NameSlot, 24 > t{};
+    for ( int32_t i = 0; i < 12; i++ )
+    {
+        t[ i ] = joinName( { nStr3[ i ], "\u6708" } );
+        t[ i + 12 ] = joinName( { "\u95f0", nStr3[ i ], "\u6708" } );
+    }
+    return t;
+}();
+
+/**
+ *  农历日名称表，下标 0 为初一
+ */
+static constexpr std::array< NameSlot, 30 > dayNames = [] {
+    std::array< NameSlot, 30 > t{};
+    for ( int32_t day = 1; day <= 30; day++ )
+    {
+        switch ( day ) {
+            case 10:
+                t[ day - 1 ] = joinName( { "\u521d\u5341" } ); break;
+            case 20:
+                t[ day - 1 ] = joinName( { "\u4e8c\u5341" } ); break;
+            case 30:
+                t[ day - 1 ] = joinName( { "\u4e09\u5341" } ); break;
+            default:
+                t[ day - 1 ] = joinName( { nStr2[ day / 10 ], nStr1[ day % 10 ] } );
+        }
+    }
+    return t;
+}();
+
+/**
+ *  公历日期换算为纪元日数（1970.1.1 为 0），闭式计算；以 64 位运算，任意 32 位年月日都不会溢出
+ */
+static constexpr int64_t daysFromCivil( int64_t year, int64_t month, int64_t day )
+{
+    year -= month <= 2;
+    const int64_t era = ( year >= 0 ? year : year - 399 ) / 400;
+    const int64_t yoe = year - era * 400;
+    const int64_t doy = ( 153 * ( month > 2 ? month - 3 : month + 9 ) + 2 ) / 5 + day - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/**
+ *  农历日信息表覆盖的天数，1900.1.31~2100.12.31
+ */
+static constexpr int32_t lunarDayCount = ( int32_t )daysFromCivil( 2100, 12, 31 ) - daysFromCivil( 1900, 1, 31 ) + 1;
+
+/**
+ *  按 lunarInfo 逐月展开的农历日信息表，首次使用时构建一次
+ */
+static const std::array< LunarDayInfo, lunarDayCount >& lunarDayTable()
+{
+    static const std::array< LunarDayInfo, lunarDayCount > table = [] {
+        std::array< LunarDayInfo, lunarDayCount > t{};
+        Lunar lunar;
+        int32_t n = 0;
+        
+        for ( int32_t year = 1900; year <= 2100 && n < lunarDayCount; year++ )
+        {
+            int32_t leap = lunar.leapMonth( year );
+            
+            for ( int32_t month = 1; month <= 12 && n < lunarDayCount; month++ )
+            {
+                // 闰月紧跟在同名月之后
+                for ( int32_t pass = 0; pass < ( month == leap ? 2 : 1 ); pass++ )
+                {
+                    bool isLeap = pass == 1;
+                    int32_t days = isLeap ? lunar.leapDays( year ) : lunar.monthDays( year, month );
+                    
+                    for ( int32_t day = 1; day <= days && n < lunarDayCount; day++, n++ )
+                    {
+                        t[ n ].lunarYear = year - 1900;
+                        t[ n ].lunarMonth = month;
+                        t[ n ].lunarDay = day;
+                        t[ n ].isLeap = isLeap;
+                        t[ n ].ganzhiDay = ( n + 40 ) % 60; // 1900.1.31 为甲辰日
+                    }
+                }
+            }
+        }
+        return t;
+    }();
+    return table;
+}
+
+int32_t Lunar::dayNumber( int32_t year, int32_t month, int32_t day )
+{
+    // 超出 32 位的天数饱和到两端，不会回绕进日信息表的区间
+    const int64_t number = daysFromCivil( year, month, day ) - daysFromCivil( 1900, 1, 31 );
+    return ( int32_t )std::clamp< int64_t >( number, std::numeric_limits< int32_t >::min(),
+                                              std::numeric_limits< int32_t >::max() );
+}
+
+const LunarDayInfo* Lunar::dayInfo( int32_t number )
+{
+    if ( number < 0 || number >= lunarDayCount ) return NULL;
+    return &lunarDayTable()[ number ];
+}
 
 int32_t Lunar::lYearDays( int32_t year )
 {
@@ -201,7 +371,35 @@ int32_t Lunar::solarDays( int32_t year, int32_t month )
 
 std::string Lunar::toGanZhi( int32_t offset )
 {
-    return( Gan[ offset % 10 ] + Zhi[ offset % 12 ] );
+    return std::string( ganzhiName( offset % 60 ) );
+}
+
+std::string_view Lunar::ganzhiName( int32_t index )
+{
+    return ganzhiNames[ index ].view();
+}
+
+std::string_view Lunar::animalName( int32_t year )
+{
+    return Animals[ ( year - 4 ) % 12 ];
+}
+
+std::string_view Lunar::monthName( int32_t month, bool isLeap )
+{
+    if ( month > 12 || month < 1 ) { return std::string_view(); }
+    return monthNames[ month - 1 + ( isLeap ? 12 : 0 ) ].view();
+}
+
+std::string_view Lunar::dayName( int32_t day )
+{
+    if ( day > 30 || day < 1 ) { return std::string_view(); }
+    return dayNames[ day - 1 ].view();
+}
+
+std::string_view Lunar::termName( int32_t term )
+{
+    if ( term > 24 || term < 1 ) { return std::string_view(); }
+    return solarTerm[ term - 1 ];
 }
 
 int32_t Lunar::getTerm( int32_t year, int32_t number )
@@ -209,228 +407,100 @@ int32_t Lunar::getTerm( int32_t year, int32_t number )
     if ( year < 1900 || year > 2100 ) { return -1; }
     if ( number < 1 || number > 24 ) { return -1; }
     
-    std::string _table = sTermInfo[ year - 1900 ];
-    std::vector< std::string > _info = std::vector< std::string >();
-    
-    for (int32_t i=0; i<6; i++) {
-        std::string tmp = _table.substr( i * 5, 5 );
-        tmp = "0x" + tmp;
-        int32_t number = (int32_t) strtol( tmp.c_str(), NULL, 16 );
-        _info.push_back( std::to_string( number ) );
-    }
-    
-    std::vector< int32_t > _calday = std::vector< int32_t >();
-    
-    for (int32_t i=0; i<6; i++) {
-        _calday.push_back( std::stoi( _info[ i ].substr( 0, 1 ) ));
-        _calday.push_back( std::stoi( _info[ i ].substr( 1, 2 ) ));
-        _calday.push_back( std::stoi( _info[ i ].substr( 3, 1 ) ));
-        _calday.push_back( std::stoi( _info[ i ].substr( 4, 2 ) ));
-    }
-    
-    return _calday[ number - 1 ];
+    return sTermDays[ year - 1900 ][ number - 1 ];
 }
 
 std::string Lunar::toChinaMonth( int32_t month )
 {
-    if ( month > 12 || month < 1 ) { return ""; } //若参数错误 返回""
-    std::string s = nStr3[ month - 1 ];
-    s+= "\u6708";//加上月字
-    return s;
+    return std::string( monthName( month, false ) ); //若参数错误 返回""
 }
 
 std::string Lunar::toChinaDay( int32_t day )
 {
-    std::string s;
-    
-    switch ( day ) {
-        case 10:
-            s = "\u521d\u5341"; break;
-        case 20:
-            s = "\u4e8c\u5341"; break;
-            break;
-        case 30:
-            s = "\u4e09\u5341"; break;
-            break;
-        default :
-            
-            s = nStr2[ (int32_t) floor( day / 10 ) ];
-            s += nStr1[ day % 10 ];
-    }
-    
-    return( s );
+    return std::string( dayName( day ) );
 }
 
 std::string Lunar::getAnimal( int32_t year )
 {
-    return Animals[ ( year - 4 ) % 12 ];
+    return std::string( animalName( year ) );
 }
 
 int32_t Lunar::deltaDaysWith19000131(int32_t year, int32_t month, int32_t day)
 {
-    if (year == 1900)
-    {
-        int32_t s = 0;
-        for (int32_t m=2; m<month; m++) {
-            s += this->solarDays(year, m);
-        }
-        
-        if (month != 1)
-            s += day;
-        
-        return s;
-    }
-    else
-    {
-        int32_t s = 365 - 31;
-        for (int32_t i=1901; i<year; i++)
-        {
-            s += ((i % 4 == 0 && i % 100 != 0) || i % 400 == 0) ? 366 : 365;
-        }
-        
-        if (month != 1)
-        {
-            for (int32_t i=1; i < month; i++) {
-                s += this->solarDays(year, i);
-            }
-        }
-        
-        s += day;
-        
-        return s;
-    }
+    return dayNumber( year, month, day );
 }
 
-LunarObj* Lunar::solar2lunar( int32_t year, int32_t month, int32_t day )
+std::optional< LunarDate > Lunar::solar2lunarDate( int32_t year, int32_t month, int32_t day )
 {
-    if ( year < 1900 || year > 2100 ) return NULL;
-    if ( year == 1900 && month ==1 && day < 31) return NULL;
+    if ( year < 1900 || year > 2100 ) return std::nullopt;
+    if ( year == 1900 && month ==1 && day < 31) return std::nullopt;
+    if ( day < 1 || day > solarDays( year, month ) ) return std::nullopt;
     
-    int32_t i = 0, temp = 0, leap = 0;
+    const LunarDayInfo* info = dayInfo( dayNumber( year, month, day ) );
+    if ( info == NULL ) return std::nullopt;
     
-    int32_t offset = this->deltaDaysWith19000131(year, month, day);
-
-    for (i=1900; i<2101 && offset > 0; i++)
-    {
-        temp = lYearDays( i );
-        offset -= temp;
-    }
+    LunarDate date{};
     
-    if ( offset < 0 )  {
-        offset += temp;
-        i--;
-    }
+    date.lunarYear = 1900 + info->lunarYear;
+    date.lunarMonth = info->lunarMonth;
+    date.lunarDay = info->lunarDay;
+    date.isLeap = info->isLeap;
     
-//#warning TODO: 是否是今天
-//#warning TODO: 星期几
+    date.solarYear = year;
+    date.solarMonth = month;
+    date.solarDay = day;
     
-    int32_t lunarYear = i;
-    leap = this->leapMonth( i );
-    
-    bool isLeap = false;
-    
-    for ( i=1; i<13 && offset > 0; i++ )
-    {
-        if ( leap > 0 && i == ( leap + 1 ) && isLeap == false )
-        {
-            --i;
-            isLeap = true;
-            temp = this->leapDays( lunarYear );
-        }
-        else
-        {
-            temp = this->monthDays( lunarYear, i);
-        }
-        
-        if ( isLeap == true && i == ( leap + 1 ))
-        {
-            isLeap = false;
-        }
-        
-        offset -= temp;
-    }
-    
-    if ( offset == 0 && leap > 0 && i == leap + 1 )
-    {
-        if ( isLeap ) {
-            isLeap = false;
-        }
-        else
-        {
-            isLeap = true;
-            --i;
-        }
-    }
-    
-    if ( offset < 0 )
-    {
-        offset += temp;
-        --i;
-    }
-    
-    int32_t lunarMonth = i;
-    int32_t lunarDay = (int32_t) offset + 1;
-    
-    int32_t sm = month - 1;
-    int32_t term3 = this->getTerm( lunarYear, 3 );
-    std::string gzY = this->toGanZhi( lunarYear - 4 );
-    
-    if ( sm < 2 && day < term3 ) {
-        gzY = this->toGanZhi( lunarYear - 5);
-    }
-    else
-    {
-        gzY = this->toGanZhi( lunarYear - 4);
-    }
+    // 年干支以立春为界
+    int32_t term3 = this->getTerm( year, 3 );
+    bool beforeSpring = month < 2 || ( month == 2 && day < term3 );
+    date.ganzhiYear = ( year - 4 - ( beforeSpring ? 1 : 0 ) ) % 60;
     
+    // 月干支以当月第一个节为界
     int32_t firstNode = this->getTerm( year, month * 2 - 1 );
-    int32_t secondNode = this->getTerm( year, month * 2);
+    int32_t secondNode = this->getTerm( year, month * 2 );
+    date.ganzhiMonth = ( ( year - 1900 ) * 12 + month + ( day >= firstNode ? 12 : 11 ) ) % 60;
     
-    std::string gzM = this->toGanZhi( ( year - 1900 ) * 12 + month + 11 );
+    date.ganzhiDay = info->ganzhiDay;
     
-    if ( day >= firstNode ) {
-        gzM = this->toGanZhi( ( year - 1900 ) * 12 + month + 12 );
-    }
-
-    bool isTerm = false;
-    std::string Term = "";
-
     if ( firstNode == day )
     {
-        isTerm = true;
-        Term = solarTerm[ month * 2 - 2 ];
+        date.term = month * 2 - 1;
     }
-
+    
     if ( secondNode == day )
     {
-        isTerm = true;
-        Term = solarTerm[ month * 2 -1 ];
+        date.term = month * 2;
     }
     
-    int32_t dayCyclical =  (int32_t) (deltaDaysWith19000131(year, sm+1, 1)+30)  + 10;
-    std::string gzD = this->toGanZhi( dayCyclical + day - 1);
+    return date;
+}
 
+LunarObj* Lunar::solar2lunar( int32_t year, int32_t month, int32_t day )
+{
+    std::optional< LunarDate > date = this->solar2lunarDate( year, month, day );
+    if ( !date ) return NULL;
+    
     LunarObj* obj = new LunarObj;
 
-    obj->lunarYear = lunarYear;
-    obj->lunarMonth = lunarMonth;
-    obj->lunarDay = lunarDay;
+    obj->lunarYear = date->lunarYear;
+    obj->lunarMonth = date->lunarMonth;
+    obj->lunarDay = date->lunarDay;
     
-    obj->animal = this->getAnimal( lunarYear );
-    obj->lunarMonthChineseName = ( isLeap ? "\u95f0" : "" ) + this->toChinaMonth( lunarMonth );
-    obj->lunarDayChineseName = this->toChinaDay( lunarDay );
+    obj->animal = animalName( date->lunarYear );
+    obj->lunarMonthChineseName = monthName( date->lunarMonth, date->isLeap );
+    obj->lunarDayChineseName = dayName( date->lunarDay );
     
     obj->solarYear = year;
     obj->solarMonth = month;
     obj->solarDay = day;
     
-    obj->ganzhiYear = gzY;
-    obj->ganzhiMonth = gzM;
-    obj->ganzhiDay = gzD;
+    obj->ganzhiYear = ganzhiName( date->ganzhiYear );
+    obj->ganzhiMonth = ganzhiName( date->ganzhiMonth );
+    obj->ganzhiDay = ganzhiName( date->ganzhiDay );
     
-    obj->isLeap = isLeap;
-    obj->term = Term;
-    obj->isTerm = isTerm;
+    obj->isLeap = date->isLeap;
+    obj->term = termName( date->term );
+    obj->isTerm = date->term != 0;
     
     return obj;
 }
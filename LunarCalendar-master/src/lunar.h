@@ -11,8 +11,33 @@
 
 #include <cstdint>
 #include <iostream>
+#include <optional>
+#include <span>
+#include <string_view>
 #include <stdio.h>
 
+/**
+ *  按日索引的农历信息，1900.1.31~2100.12.31 每日一项，打包为 32 位
+ */
+struct LunarDayInfo {
+    uint32_t lunarYear  : 8;    // 农历年 - 1900
+    uint32_t lunarMonth : 4;    // 农历月 1~12
+    uint32_t lunarDay   : 5;    // 农历日 1~30
+    uint32_t isLeap     : 1;    // 是否闰月
+    uint32_t ganzhiDay  : 6;    // 日干支序号 0~59，0 为甲子
+};
+
+/**
+ *  农历信息值类型，可平凡复制；干支以 0~59 序号表示（0 为甲子），中文名称按需查表
+ */
+struct LunarDate {
+    int32_t lunarYear, solarYear;
+    uint8_t lunarMonth, lunarDay, solarMonth, solarDay;
+    uint8_t ganzhiYear, ganzhiMonth, ganzhiDay;     // 年、月、日干支序号 0~59
+    uint8_t term;                                   // 当日节气 1~24（自小寒起），0 为无
+    bool isLeap;
+};
+
 struct LunarObj {
     int32_t lunarYear, lunarMonth, lunarDay, solarYear, solarMonth, solarDay, weekNumber;
     std::string animal, lunarMonthChineseName, lunarDayChineseName, ganzhiYear, ganzhiMonth, ganzhiDay, term, weekChineseName;
@@ -67,7 +92,7 @@ public:
      *
      *  @return -1/28/29/30/31
      */
-    int32_t solarDays( int32_t year, int32_t month );
+    static int32_t solarDays( int32_t year, int32_t month );
     
     /**
      *  传入 offset 偏移量，返回干支
@@ -115,6 +140,85 @@ public:
      */
     std::string getAnimal( int32_t year );
     
+    /**
+     *  干支序号的中文名称
+     *
+     *  @param index(0~59) 干支序号，0 为甲子
+     *
+     *  @return 静态表中的字符串
+     */
+    static std::string_view ganzhiName( int32_t index );
+    
+    /**
+     *  农历年对应的生肖名称
+     *
+     *  @param year(1900~2100) 农历年
+     *
+     *  @return 静态表中的字符串
+     */
+    static std::string_view animalName( int32_t year );
+    
+    /**
+     *  农历月的中文名称，闰月带“闰”字
+     *
+     *  @param month(1~12) 农历月
+     *  @param isLeap      是否闰月
+     *
+     *  @return 静态表中的字符串；参数错误返回空串
+     */
+    static std::string_view monthName( int32_t month, bool isLeap );
+    
+    /**
+     *  农历日的中文名称
+     *
+     *  @param day(1~30) 农历日
+     *
+     *  @return 静态表中的字符串；参数错误返回空串
+     */
+    static std::string_view dayName( int32_t day );
+    
+    /**
+     *  节气名称
+     *
+     *  @param term(1~24) 节气序号，从 1 (小寒) 算起
+     *
+     *  @return 静态表中的字符串；0 或参数错误返回空串
+     */
+    static std::string_view termName( int32_t term );
+    
+    /**
+     *  公历日期距 1900.1.31 的天数，闭式计算
+     *
+     *  @param year  公历年
+     *  @param month 公历月
+     *  @param day   公历日
+     *
+     *  @return 天数，1900.1.31 为 0；超出 32 位时饱和为 INT32_MIN / INT32_MAX，dayInfo 对其返回 NULL
+     */
+    static int32_t dayNumber( int32_t year, int32_t month, int32_t day );
+    
+    /**
+     *  按日序号查预计算的农历信息表
+     *
+     *  @param number 距 1900.1.31 的天数，参见 dayNumber
+     *
+     *  @return 该日的农历信息；超出 1900.1.31~2100.12.31 时返回 NULL
+     */
+    static const LunarDayInfo* dayInfo( int32_t number );
+    
+    /**
+     *  成批把公历日期换算为农历日信息，x86 上支持 AVX2 时每次处理 8 个日期
+     *
+     *  @param year  公历年
+     *  @param month 公历月
+     *  @param day   公历日，三个数组等长
+     *  @param out   输出，不短于输入；超出 1900.1.31~2100.12.31 或月、日非法（如 2 月 30 日）的项全为 0（lunarMonth 为 0）
+     *
+     *  @return 超出区间或非法的项数
+     */
+    static size_t solar2lunarBulk( std::span< const int32_t > year, std::span< const uint8_t > month,
+                                   std::span< const uint8_t > day, std::span< LunarDayInfo > out );
+    
     int32_t deltaDaysWith19000131(int32_t year, int32_t month, int32_t day);
 
     /**
@@ -128,6 +232,17 @@ public:
      */
     LunarObj* solar2lunar( int32_t year, int32_t month, int32_t day);
     
+    /**
+     *  传入公历年月日获得农历信息值，不分配内存，参数区间1900.1.31~2100.12.31
+     *
+     *  @param year  公历年
+     *  @param month 公历月
+     *  @param day   公历日
+     *
+     *  @return 农历信息；超出区间或该月无此日时为空
+     */
+    std::optional< LunarDate > solar2lunarDate( int32_t year, int32_t month, int32_t day );
+    
     /**
      *  传入农历年月日以及传入的月份是否闰月获得详细的公历、农历信息，参数区间1900.1.31~2100.12.1
      *
@@ -0,0 +1,144 @@
+//
+//  lunar_bulk.cpp
+//  LunarCore
+//
+//  成批公历转农历：闭式日数计算加农历日信息表查找
+//
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "lunar.h"
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define LUNAR_HAS_AVX2_KERNEL 1
+#define LUNAR_AVX2 __attribute__( ( target( "avx2" ) ) )
+#include <immintrin.h>
+#endif
+
+static_assert( sizeof( LunarDayInfo ) == sizeof( uint32_t ) );
+
+/**
+ *  年限于 1900~2100、月 1~12、日不越出本月，与 solar2lunarDate 的校验相同；向量实现按同一规则逐道校验
+ */
+static bool validSolar( int32_t year, uint8_t month, uint8_t day )
+{
+    return year >= 1900 && year <= 2100 && month >= 1 && month <= 12 && day >= 1 &&
+           day <= Lunar::solarDays( year, month );
+}
+
+/**
+ *  标量换算 [begin, end)，返回超出区间的项数
+ */
+static size_t solar2lunarRange( std::span< const int32_t > year, std::span< const uint8_t > month,
+                                std::span< const uint8_t > day, std::span< LunarDayInfo > out,
+                                size_t begin, size_t end )
+{
+    size_t invalid = 0;
+    for ( size_t i = begin; i < end; i++ )
+    {
+        const LunarDayInfo* info = NULL;
+        if ( validSolar( year[ i ], month[ i ], day[ i ] ) )
+        {
+            info = Lunar::dayInfo( Lunar::dayNumber( year[ i ], month[ i ], day[ i ] ) );
+        }
+        out[ i ] = info ? *info : LunarDayInfo{};
+        invalid += info == NULL;
+    }
+    return invalid;
+}
+
+#ifdef LUNAR_HAS_AVX2_KERNEL
+
+/**
+ *  自三月起算的月首日数（闭式公式 (153 * m + 2) / 5 的取值），下标为公历月，0 不用
+ */
+alignas( 32 ) static const int32_t monthOffset[ 13 ] = {
+    0, 306, 337, 0, 31, 61, 92, 122, 153, 184, 214, 245, 275
+};
+
+/**
+ *  平年各月天数，下标为公历月，0 不用（月非法时取到 0，日必越界）
+ */
+alignas( 32 ) static const int32_t monthLength[ 13 ] = {
+    0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+LUNAR_AVX2 static size_t solar2lunarAvx2( std::span< const int32_t > year, std::span< const uint8_t > month,
+                                          std::span< const uint8_t > day, std::span< LunarDayInfo > out )
+{
+    const LunarDayInfo* first = Lunar::dayInfo( 0 );
+    const int32_t count = Lunar::dayNumber( 2100, 12, 31 ) + 1;
+    const int* table = reinterpret_cast< const int* >( first );
+    const __m256i one = _mm256_set1_epi32( 1 );
+    size_t invalid = 0;
+    size_t i = 0;
+    
+    for ( ; i + 8 <= year.size(); i += 8 )
+    {
+        __m256i y = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( year.data() + i ) );
+        __m256i m = _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast< const __m128i* >( month.data() + i ) ) );
+        __m256i d = _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast< const __m128i* >( day.data() + i ) ) );
+        
+        // 年份限于 1900~2100、月份 1~12，闭式公式中的整除因此只有几个取值
+        __m256i valid = _mm256_and_si256( _mm256_cmpgt_epi32( y, _mm256_set1_epi32( 1899 ) ),
+                                          _mm256_cmpgt_epi32( _mm256_set1_epi32( 2101 ), y ) );
+        valid = _mm256_and_si256( valid, _mm256_and_si256( _mm256_cmpgt_epi32( m, _mm256_setzero_si256() ),
+                                                           _mm256_cmpgt_epi32( _mm256_set1_epi32( 13 ), m ) ) );
+        m = _mm256_and_si256( m, valid );
+        
+        // 日限于 1~本月天数；区间内除 1900、2100 外逢四即闰，闰年二月加一日
+        __m256i leap = _mm256_and_si256( _mm256_cmpeq_epi32( _mm256_and_si256( y, _mm256_set1_epi32( 3 ) ), _mm256_setzero_si256() ),
+                                         _mm256_andnot_si256( _mm256_or_si256( _mm256_cmpeq_epi32( y, _mm256_set1_epi32( 1900 ) ),
+                                                                               _mm256_cmpeq_epi32( y, _mm256_set1_epi32( 2100 ) ) ),
+                                                              _mm256_cmpeq_epi32( m, _mm256_set1_epi32( 2 ) ) ) );
+        __m256i length = _mm256_sub_epi32( _mm256_i32gather_epi32( monthLength, m, 4 ), leap );
+        valid = _mm256_and_si256( valid, _mm256_and_si256( _mm256_cmpgt_epi32( d, _mm256_setzero_si256() ),
+                                                           _mm256_cmpgt_epi32( _mm256_add_epi32( length, one ), d ) ) );
+        
+        // 一、二月计入上一年
+        __m256i shifted = _mm256_add_epi32( y, _mm256_cmpgt_epi32( _mm256_set1_epi32( 3 ), m ) );
+        __m256i ge1900 = _mm256_and_si256( _mm256_cmpgt_epi32( shifted, _mm256_set1_epi32( 1899 ) ), one );
+        __m256i ge2000 = _mm256_and_si256( _mm256_cmpgt_epi32( shifted, _mm256_set1_epi32( 1999 ) ), one );
+        __m256i ge2100 = _mm256_and_si256( _mm256_cmpgt_epi32( shifted, _mm256_set1_epi32( 2099 ) ), one );
+        __m256i centuries = _mm256_add_epi32( _mm256_set1_epi32( 18 ), _mm256_add_epi32( ge1900, _mm256_add_epi32( ge2000, ge2100 ) ) );
+        __m256i quadCenturies = _mm256_add_epi32( _mm256_set1_epi32( 4 ), ge2000 );
+        
+        // 365 * y + y / 4 - y / 100 + y / 400 + 月首 + 日，再减去 1900.1.31 的同一算式
+        __m256i days = _mm256_mullo_epi32( shifted, _mm256_set1_epi32( 365 ) );
+        days = _mm256_add_epi32( days, _mm256_srli_epi32( shifted, 2 ) );
+        days = _mm256_sub_epi32( days, centuries );
+        days = _mm256_add_epi32( days, quadCenturies );
+        days = _mm256_add_epi32( days, _mm256_i32gather_epi32( monthOffset, m, 4 ) );
+        days = _mm256_add_epi32( days, d );
+        __m256i number = _mm256_sub_epi32( days, _mm256_set1_epi32( 365 * 1899 + 1899 / 4 - 1899 / 100 + 1899 / 400 + 306 + 31 ) );
+        
+        valid = _mm256_and_si256( valid, _mm256_and_si256( _mm256_cmpgt_epi32( number, _mm256_set1_epi32( -1 ) ),
+                                                           _mm256_cmpgt_epi32( _mm256_set1_epi32( count ), number ) ) );
+        __m256i info = _mm256_mask_i32gather_epi32( _mm256_setzero_si256(), table,
+                                                    _mm256_and_si256( number, valid ), valid, 4 );
+        _mm256_storeu_si256( reinterpret_cast< __m256i* >( out.data() + i ), info );
+        invalid += 8 - __builtin_popcount( _mm256_movemask_ps( _mm256_castsi256_ps( valid ) ) );
+    }
+    return invalid + solar2lunarRange( year, month, day, out, i, year.size() );
+}
+
+#endif // LUNAR_HAS_AVX2_KERNEL
+
+size_t Lunar::solar2lunarBulk( std::span< const int32_t > year, std::span< const uint8_t > month,
+                               std::span< const uint8_t > day, std::span< LunarDayInfo > out )
+{
+    if ( month.size() != year.size() || day.size() != year.size() || out.size() < year.size() )
+    {
+        throw std::invalid_argument( "solar2lunarBulk: 数组长度不一致" );
+    }
+#ifdef LUNAR_HAS_AVX2_KERNEL
+    static const bool hasAvx2 = __builtin_cpu_supports( "avx2" );
+    if ( hasAvx2 )
+    {
+        return solar2lunarAvx2( year, month, day, out );
+    }
+#endif
+    return solar2lunarRange( year, month, day, out, 0, year.size() );
+}
@@ -0,0 +1,89 @@
+#include "batch.hpp"
+#include "course_table.hpp"
+#include "lunar.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 每个线程至少分到的项数，过小的批次不值得起线程
+constexpr std::size_t minChunk = 4096;
+
+std::size_t computeRange(std::span<const ChartInput> input, std::span<Chart> output) {
+  std::size_t failed = 0;
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    std::optional<Chart> chart = chartAt(input[i]);
+    output[i] = chart.value_or(Chart{});
+    failed += !chart;
+  }
+  return failed;
+}
+
+} // namespace
+
+std::optional<Chart> chartAt(const ChartInput &input, ChartFieldMask fields,
+                             ShenShaPlate *shenSha) {
+  // 年份先限于日信息表所及，不让任意 32 位年进入日数计算
+  if (input.year < 1900 || input.year > 2100 || input.month < 1 || input.month > 12 ||
+      input.day < 1 || input.day > Lunar::solarDays(input.year, input.month) ||
+      input.hour > 23) {
+    return std::nullopt;
+  }
+  int32_t number = Lunar::dayNumber(input.year, input.month, input.day);
+  const LunarDayInfo *info = Lunar::dayInfo(number);
+  if (info == NULL) {
+    return std::nullopt;
+  }
+  Pillar day = dayPillar(number);
+  EarthlyBranch moonGeneral = getMoonGeneral(info->lunarMonth);
+  // 太岁、月建以立春、节气为界，日表中没有，只在要神煞时才排一次农历
+  if ((fields & ChartFieldShenSha) && shenSha != nullptr) {
+    Lunar lunar;
+    std::optional<LunarDate> date = lunar.solar2lunarDate(input.year, input.month, input.day);
+    if (!date) {
+      return std::nullopt;
+    }
+    *shenSha = computeShenSha(fourPillars(*date, input.hour));
+  }
+  // 需要四课时查课表，否则现算天盘、贵人，不触及课表
+  if (withDependencies(fields) & ChartFieldLessons) {
+    return lookupChart(day.stem, day.branch, moonGeneral, hourBranchOf(input.hour));
+  }
+  return computeChart(day.stem, day.branch, moonGeneral, hourBranchOf(input.hour), fields);
+}
+
+std::size_t computeCharts(std::span<const ChartInput> input, std::span<Chart> output,
+                          unsigned threads) {
+  if (output.size() < input.size()) {
+    throw std::invalid_argument("computeCharts: output 短于 input");
+  }
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  // 按连续区间切分，各线程只写自己的区间，输出顺序与输入一致
+  std::size_t parts = std::min<std::size_t>(threads, (input.size() + minChunk - 1) / minChunk);
+  if (parts <= 1) {
+    return computeRange(input, output);
+  }
+  std::vector<std::size_t> failed(parts);
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(parts - 1);
+    std::size_t chunk = (input.size() + parts - 1) / parts;
+    for (std::size_t p = 1; p < parts; ++p) {
+      std::size_t begin = std::min(p * chunk, input.size());
+      std::size_t count = std::min(chunk, input.size() - begin);
+      workers.emplace_back([&, p, begin, count] {
+        failed[p] = computeRange(input.subspan(begin, count), output.subspan(begin, count));
+      });
+    }
+    failed[0] = computeRange(input.first(std::min(chunk, input.size())), output);
+  }
+  std::size_t total = 0;
+  for (std::size_t f : failed) {
+    total += f;
+  }
+  return total;
+}
@@ -0,0 +1,43 @@
+//
+// 批量起课：公历日期与钟点直接得到课盘，可按线程切分大批输入
+//
+
+#ifndef DA_LIU_REN_BATCH_HPP
+#define DA_LIU_REN_BATCH_HPP
+
+#include "chart.hpp"
+#include "shen_sha.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+// 本命未知
+inline constexpr uint8_t birthUnknown = 0xff;
+
+// 一次起课的输入：公历年月日与钟点（0~23），以及可选的本命地支（只用于毕法格局）
+struct ChartInput {
+  int32_t year;
+  uint8_t month;
+  uint8_t day;
+  uint8_t hour;
+  uint8_t birth = birthUnknown;
+
+  std::optional<EarthlyBranch> birthBranch() const {
+    return birth < 12 ? std::optional(static_cast<EarthlyBranch>(birth)) : std::nullopt;
+  }
+};
+
+// 单次起课，以农历月取月将；日期超出 1900.1.31~2100.12.31 或年月日时非法时为空。
+// fields 为所需部分（参见 ChartField），未请求的字段可能为 0 也可能已填好。
+// fields 含 ChartFieldShenSha 且 shenSha 非空时，另按节气定年、月支求十二宫神煞写入 *shenSha
+std::optional<Chart> chartAt(const ChartInput &input, ChartFieldMask fields = chartFieldsAll,
+                             ShenShaPlate *shenSha = nullptr);
+
+// 批量起课，output[i] 对应 input[i]，与线程数无关；无法起课的项置为 Chart{}
+// （patterns[0] 为 None）。threads 为 0 时取硬件并发数。返回无法起课的项数。
+// output 短于 input 时抛出 std::invalid_argument
+std::size_t computeCharts(std::span<const ChartInput> input, std::span<Chart> output,
+                          unsigned threads = 0);
+
+#endif // DA_LIU_REN_BATCH_HPP
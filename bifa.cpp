@@ -0,0 +1,144 @@
+#include "bifa.hpp"
+#include "course_table.hpp"
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// 不计本命时，格局只取决于日干支、天盘旋转与占时（月将即占时加旋转）
+constexpr int biFaIndex(int dayPillar, int rotation, int hour) {
+  return (dayPillar * 12 + rotation) * 12 + hour;
+}
+
+// 60 日干支 × 12 旋转 × 12 占时的格局表，首次使用时由 720 课表生成
+const std::vector<BiFaSet> &biFaTable() {
+  static const std::vector<BiFaSet> table = [] {
+    std::vector<BiFaSet> sets(60 * 12 * 12);
+    for (int pillar = 0; pillar < 60; ++pillar) {
+      Pillar day = pillarOf(pillar);
+      for (int rotation = 0; rotation < 12; ++rotation) {
+        for (int hour = 0; hour < 12; ++hour) {
+          Chart chart = lookupChart(day.stem, day.branch,
+                                    static_cast<EarthlyBranch>((hour + rotation) % 12),
+                                    static_cast<EarthlyBranch>(hour));
+          sets[biFaIndex(pillar, rotation, hour)] = classifyBiFa(chart);
+        }
+      }
+    }
+    return sets;
+  }();
+  return table;
+}
+
+// 样例课盘：格局名、日干、日支、月将、占时与本命（0xff 为不计本命），
+// 毕法赋每句取一个能由课盘判定的格局，课盘为 8640 课中最先命中者
+struct Sample {
+  std::u8string_view name;
+  uint8_t stem;
+  uint8_t branch;
+  uint8_t moonGeneral;
+  uint8_t hour;
+  uint8_t birth;
+};
+
+constexpr Sample samples[] = {
+    {u8"拱贵格", 2, 2, 0, 7, 0xff}, // 丙寅日 子将 未时
+    {u8"二贵拱年命格", 2, 2, 0, 0, 10}, // 丙寅日 子将 子时 本命戌
+    {u8"周而复始格", 1, 1, 0, 4, 0xff}, // 乙丑日 子将 辰时
+    {u8"帘幕格", 0, 0, 0, 1, 0xff}, // 甲子日 子将 丑时
+    {u8"催官使者", 0, 0, 0, 6, 0xff}, // 甲子日 子将 午时
+    {u8"六阳格", 0, 0, 0, 2, 0xff}, // 甲子日 子将 寅时
+    {u8"旺禄临身格", 0, 0, 0, 0, 0xff}, // 甲子日 子将 子时
+    {u8"斫轮课", 1, 1, 0, 5, 0xff}, // 乙丑日 子将 巳时
+    {u8"众鬼不惧格", 0, 0, 0, 8, 0xff}, // 甲子日 子将 申时
+    {u8"狐假虎威格", 0, 0, 0, 1, 0xff}, // 甲子日 子将 丑时
+    {u8"进退连茹为财格", 9, 9, 0, 1, 0xff}, // 癸酉日 子将 丑时
+    {u8"脱上脱格", 0, 0, 6, 3, 0xff}, // 甲子日 午将 卯时
+    {u8"空上天空格", 8, 8, 3, 3, 0xff}, // 壬申日 卯将 卯时
+    {u8"进茹空亡格", 9, 9, 0, 11, 0xff}, // 癸酉日 子将 亥时
+    {u8"踏脚空亡格", 0, 0, 0, 2, 0xff}, // 甲子日 子将 寅时
+    {u8"私孕格", 1, 1, 0, 3, 0xff}, // 乙丑日 子将 卯时
+    {u8"交车长生", 7, 7, 0, 2, 0xff}, // 辛未日 子将 寅时
+    {u8"上下俱合格", 3, 1, 0, 1, 0xff}, // 丁丑日 子将 丑时
+    {u8"支传干格", 7, 7, 0, 0, 0xff}, // 辛未日 子将 子时
+    {u8"金日逢丁格", 6, 6, 0, 3, 0xff}, // 庚午日 子将 卯时
+    {u8"借钱还债格", 1, 1, 0, 0, 0xff}, // 乙丑日 子将 子时
+    {u8"人胜宅格", 4, 2, 0, 4, 0xff}, // 戊寅日 子将 辰时
+    {u8"递生格", 0, 0, 0, 8, 0xff}, // 甲子日 子将 申时
+    {u8"有始无终格", 1, 1, 0, 2, 0xff}, // 乙丑日 子将 寅时
+    {u8"干支俱脱格", 0, 0, 0, 9, 0xff}, // 甲子日 子将 酉时
+    {u8"干支皆败格", 1, 1, 0, 4, 0xff}, // 乙丑日 子将 辰时
+    {u8"末助初生干格", 4, 4, 0, 0, 0xff}, // 戊辰日 子将 子时
+    {u8"闭口课", 0, 0, 0, 3, 0xff}, // 甲子日 子将 卯时
+    {u8"太阳照武格", 0, 0, 10, 0, 0xff}, // 甲子日 戌将 子时
+    {u8"干支后合格", 3, 3, 0, 5, 0xff}, // 丁卯日 子将 巳时
+    {u8"贵害相加格", 0, 0, 0, 5, 0xff}, // 甲子日 子将 巳时
+    {u8"贵人临身格", 1, 1, 0, 4, 0xff}, // 乙丑日 子将 辰时
+    {u8"两贵受克格", 1, 1, 0, 10, 0xff}, // 乙丑日 子将 戌时
+    {u8"魁渡天门格", 8, 8, 0, 1, 0xff}, // 壬申日 子将 丑时
+    {u8"两蛇夹墓格", 1, 1, 0, 10, 0xff}, // 乙丑日 子将 戌时
+    {u8"天罗地网格", 0, 0, 0, 11, 0xff}, // 甲子日 子将 亥时
+    {u8"太阳射宅格", 0, 0, 0, 0, 0xff}, // 甲子日 子将 子时
+    {u8"墓虎加干格", 1, 1, 6, 3, 0xff}, // 乙丑日 午将 卯时
+    {u8"芜淫卦", 0, 0, 0, 4, 0xff}, // 甲子日 子将 辰时
+    {u8"支墓作财格", 0, 0, 0, 0, 0xff}, // 甲子日 子将 子时
+    {u8"绝体卦", 1, 1, 0, 5, 0xff}, // 乙丑日 子将 巳时
+    {u8"救神临支格", 0, 0, 0, 6, 0xff}, // 甲子日 子将 午时
+    {u8"初传上下皆克格", 0, 0, 0, 6, 0xff}, // 甲子日 子将 午时
+    {u8"三传皆空格", 8, 10, 4, 3, 0xff}, // 壬戌日 辰将 卯时
+    {u8"支上乘刑格", 1, 11, 0, 0, 0xff}, // 乙亥日 子将 子时
+    {u8"彼此猜忌格", 3, 1, 0, 7, 0xff}, // 丁丑日 子将 未时
+    {u8"互生格", 4, 4, 0, 11, 0xff}, // 戊辰日 子将 亥时
+    {u8"支干乘绝格", 1, 1, 0, 8, 0xff}, // 乙丑日 子将 申时
+    {u8"传墓入墓格", 1, 1, 0, 6, 0xff}, // 乙丑日 子将 午时
+    {u8"三六相呼格", 1, 1, 0, 4, 0xff}, // 乙丑日 子将 辰时
+    {u8"天后内战格", 2, 2, 0, 4, 0xff}, // 丙寅日 子将 辰时
+    {u8"干支坐墓格", 1, 1, 0, 3, 0xff}, // 乙丑日 子将 卯时
+    {u8"任信丁马格", 0, 0, 0, 0, 0xff}, // 甲子日 子将 子时
+    {u8"虎临干鬼格", 0, 0, 0, 6, 0xff}, // 甲子日 子将 午时
+    {u8"见生不生格", 0, 0, 0, 0, 0xff}, // 甲子日 子将 子时
+    {u8"财爻现卦", 1, 1, 0, 4, 0xff}, // 乙丑日 子将 辰时
+};
+
+// 各样例命中所标格局
+static_assert([] {
+  for (const Sample &s : samples) {
+    Chart chart =
+        computeChart(static_cast<HeavenlyStem>(s.stem), static_cast<EarthlyBranch>(s.branch),
+                     static_cast<EarthlyBranch>(s.moonGeneral), static_cast<EarthlyBranch>(s.hour));
+    std::optional<EarthlyBranch> birth;
+    if (s.birth < 12) {
+      birth = static_cast<EarthlyBranch>(s.birth);
+    }
+    std::size_t id = biFaId(s.name);
+    if (id == biFaCount || !contains(classifyBiFa(chart, birth), id)) {
+      return false;
+    }
+  }
+  return true;
+}());
+
+} // namespace
+
+const BiFaSet &lookupBiFa(const Chart &chart) {
+  int pillar = pillarIndex({static_cast<HeavenlyStem>(chart.dayStem),
+                            static_cast<EarthlyBranch>(chart.dayBranch)});
+  return biFaTable()[biFaIndex(pillar, chart.heavenPlate[0], chart.hourBranch)];
+}
+
+void classifyBiFaBatch(std::span<const Chart> charts, std::span<BiFaSet> out,
+                       std::span<const uint8_t> births) {
+  if (out.size() < charts.size()) {
+    throw std::invalid_argument("classifyBiFaBatch: out 短于 charts");
+  }
+  if (!births.empty() && births.size() != charts.size()) {
+    throw std::invalid_argument("classifyBiFaBatch: births 与 charts 不等长");
+  }
+  for (std::size_t i = 0; i < charts.size(); ++i) {
+    if (births.empty() || births[i] >= 12) {
+      out[i] = lookupBiFa(charts[i]);
+    } else {
+      out[i] = classifyBiFa(charts[i], static_cast<EarthlyBranch>(births[i]));
+    }
+  }
+}
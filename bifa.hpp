@@ -0,0 +1,852 @@
+//
+// 毕法赋格局：把 doc/毕法赋.md 中能由课盘（及本命）判定的格局写成条件表。
+// 每课先一次求出各规则共用的地支位置（干支上神、三传、昼夜贵人、旬首旬尾、日禄、长生墓绝等），
+// 再逐行比对条件，得到命中格局的集合
+//
+
+#ifndef DA_LIU_REN_BIFA_HPP
+#define DA_LIU_REN_BIFA_HPP
+
+#include "chart.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace bifa_detail {
+
+using namespace chart_detail;
+
+// 规则所引用的位置。0~11 为子至亥本身，其后每课求一次，值为地支，缺（未给本命）时为 0xff
+enum Role : uint8_t {
+  Zi, Chou, Yin, Mao, Chen, Si, Wu, Wei, Shen, You, Xu, Hai,
+  Stem,          // 日干：地支取寄宫，五行取日干
+  Palace,        // 日干寄宫：五行取寄宫地支
+  Branch,        // 日支
+  StemUpper,     // 干上神（第一课）
+  StemYin,       // 干阴（第二课）
+  BranchUpper,   // 支上神（第三课）
+  BranchYin,     // 支阴（第四课）
+  Initial,       // 初传
+  Middle,        // 中传
+  Final,         // 末传
+  Hour,          // 占时
+  Sun,           // 月将（太阳）
+  Noble,         // 当值贵人
+  DayNoble,      // 昼贵
+  NightNoble,    // 夜贵
+  TengShe,       // 螣蛇至天后：各天将所乘天盘地支
+  ZhuQue,
+  LiuHe,
+  GouChen,
+  QingLong,
+  TianKong,
+  BaiHu,
+  TaiChang,
+  XuanWu,
+  TaiYin,
+  TianHou,
+  XunShou,       // 旬首
+  XunWei,        // 旬尾（癸）
+  XunDing,       // 旬丁
+  Lu,            // 日禄
+  De,            // 日德
+  Horse,         // 支驿马
+  StemGrowth,    // 日干五行之长生、沐浴（败）、帝旺、墓、绝、胎
+  StemBath,
+  StemProsper,
+  StemTomb,
+  StemJue,
+  StemTai,
+  BranchGrowth,  // 日支五行之长生、沐浴、帝旺、墓、绝、胎
+  BranchBath,
+  BranchProsper,
+  BranchTomb,
+  BranchJue,
+  BranchTai,
+  InitialTomb,   // 初传之墓
+  Birth,         // 本命
+  RoleCount,
+};
+
+static_assert(RoleCount <= 64);
+
+// 位置修饰：所临地盘（天盘地支落在地盘何处）与本位上神（地盘该支之上的天盘地支）
+inline constexpr uint8_t seatBit = 0x40;
+inline constexpr uint8_t aboveBit = 0x80;
+
+constexpr uint8_t seat(Role role) { return role | seatBit; }
+constexpr uint8_t above(Role role) { return role | aboveBit; }
+
+// 地支集合，每课一次求出
+enum BranchSet : uint8_t {
+  VoidSet,       // 旬空
+  UpperSet,      // 四课上神
+  YangSet,       // 阳支
+  YinSet,        // 阴支
+  DaySide,       // 卯至申，昼方
+  NightSide,     // 酉至寅，夜方
+  KuiGangSet,    // 辰戌
+  SelfPunishSet, // 辰午酉亥自刑
+  BranchSetCount,
+};
+
+// 整课的事实
+enum Fact : uint8_t {
+  FuYinPlate,   // 伏吟
+  FanYinPlate,  // 返吟
+  YangDay,      // 刚日
+  YinDay,       // 柔日
+  Daytime,      // 昼占
+  Nighttime,    // 夜占
+  AllYang,      // 四课上神与三传皆阳
+  AllYin,       // 皆阴
+  FiveYang,     // 七位中五阳
+  FiveYin,      // 七位中五阴
+  ForwardRu,    // 三传进连茹
+  BackwardRu,   // 三传退连茹
+  BackwardGap,  // 三传退间
+  Triad,        // 三传为三合局
+  WaterTriad,   // 申子辰
+  FireTriad,    // 寅午戌
+  WoodTriad,    // 亥卯未
+  MetalTriad,   // 巳酉丑
+  HuShiPattern, // 虎视取传
+  FactCount,
+};
+
+static_assert(FactCount <= 32);
+
+// 条件种类。a、b 为位置（可带修饰），k 为地支偏移
+enum class Op : uint8_t {
+  None,             // 空条件，恒真
+  Eq,               // a 与 b 后第 k 位同支
+  Same,             // a、b 五行相同
+  Generates,        // a 生 b
+  Overcomes,        // a 克 b
+  Combine,          // a、b 六合
+  Harm,             // a、b 六害
+  Punish,           // a 刑 b
+  In,               // a 属于集合 b
+  Fact,             // 事实 b 成立
+  StemIn,           // 日干属于掩码 b
+  GeneralOvercomes, // a 所乘天将克 a
+  OvercomesGeneral, // a 克所乘天将
+  GeneratesGeneral, // a 生所乘天将
+};
+
+struct Cond {
+  Op op;
+  uint8_t a;
+  int8_t k;
+  uint16_t b;
+};
+
+// 一行规则：条件全部成立即命中 name。同名的行须相邻，取其或
+struct Row {
+  std::u8string_view name;
+  std::array<Cond, 6> conds;
+};
+
+constexpr Cond eq(uint8_t a, uint8_t b, int k = 0) {
+  return {Op::Eq, a, static_cast<int8_t>(k), b};
+}
+constexpr Cond same(uint8_t a, uint8_t b) { return {Op::Same, a, 0, b}; }
+constexpr Cond generates(uint8_t a, uint8_t b) { return {Op::Generates, a, 0, b}; }
+constexpr Cond overcomes(uint8_t a, uint8_t b) { return {Op::Overcomes, a, 0, b}; }
+constexpr Cond combine(uint8_t a, uint8_t b) { return {Op::Combine, a, 0, b}; }
+constexpr Cond harm(uint8_t a, uint8_t b) { return {Op::Harm, a, 0, b}; }
+constexpr Cond punishes(uint8_t a, uint8_t b) { return {Op::Punish, a, 0, b}; }
+constexpr Cond in(uint8_t a, BranchSet set) { return {Op::In, a, 0, set}; }
+constexpr Cond isVoid(uint8_t a) { return in(a, VoidSet); }
+constexpr Cond fact(Fact f) { return {Op::Fact, 0, 0, f}; }
+constexpr Cond generalOvercomes(uint8_t a) { return {Op::GeneralOvercomes, a, 0, 0}; }
+constexpr Cond overcomesGeneral(uint8_t a) { return {Op::OvercomesGeneral, a, 0, 0}; }
+constexpr Cond generatesGeneral(uint8_t a) { return {Op::GeneratesGeneral, a, 0, 0}; }
+
+constexpr Cond stemIn(std::initializer_list<int> stems) {
+  uint16_t mask = 0;
+  for (int s : stems) {
+    mask |= static_cast<uint16_t>(1u << s);
+  }
+  return {Op::StemIn, 0, 0, mask};
+}
+
+// 六亲：以日干为我
+constexpr Cond ghost(uint8_t a) { return overcomes(a, Stem); }  // 官鬼
+constexpr Cond wealth(uint8_t a) { return overcomes(Stem, a); } // 妻财
+constexpr Cond parent(uint8_t a) { return generates(a, Stem); } // 父母
+constexpr Cond child(uint8_t a) { return generates(Stem, a); }  // 子孙、脱气
+
+// 格局条件表，按 doc/毕法赋.md 的赋句次序。需太岁、月建、月内生气死气、行年、旺相休囚、
+// 遁干或神煞的格局不在此列
+inline constexpr auto rows = std::to_array<Row>({
+    // 前后引从升迁吉
+    {u8"引从天干格", {eq(Initial, Palace, 1), eq(Final, Palace, -1)}},
+    {u8"引从地支格", {eq(Initial, Branch, 1), eq(Final, Branch, -1)}},
+    {u8"拱贵格", {eq(Initial, Noble, 1), eq(Final, Noble, -1)}},
+    {u8"拱贵格", {eq(Initial, Noble, -1), eq(Final, Noble, 1)}},
+    {u8"两贵引从天干格", {eq(seat(DayNoble), Palace, 1), eq(seat(NightNoble), Palace, -1)}},
+    {u8"两贵引从天干格", {eq(seat(DayNoble), Palace, -1), eq(seat(NightNoble), Palace, 1)}},
+    {u8"二贵拱年命格", {eq(DayNoble, Birth, 1), eq(NightNoble, Birth, -1)}},
+    {u8"二贵拱年命格", {eq(DayNoble, Birth, -1), eq(NightNoble, Birth, 1)}},
+    {u8"干支拱定日禄格", {eq(Palace, Lu, -1), eq(Branch, Lu, 1)}},
+    {u8"干支拱定日禄格", {eq(Palace, Lu, 1), eq(Branch, Lu, -1)}},
+    {u8"干支拱昼夜贵格", {eq(Palace, DayNoble, -1), eq(Branch, DayNoble, 1)}},
+    {u8"干支拱昼夜贵格", {eq(Palace, DayNoble, 1), eq(Branch, DayNoble, -1)}},
+    {u8"干支拱昼夜贵格", {eq(Palace, NightNoble, -1), eq(Branch, NightNoble, 1)}},
+    {u8"干支拱昼夜贵格", {eq(Palace, NightNoble, 1), eq(Branch, NightNoble, -1)}},
+    {u8"初中拱地盘贵人格", {eq(Initial, Noble, 1), eq(Middle, Noble, -1)}},
+    {u8"初中拱地盘贵人格", {eq(Initial, Noble, -1), eq(Middle, Noble, 1)}},
+    // 首尾相见始终宜
+    {u8"周而复始格", {eq(StemUpper, XunShou), eq(BranchUpper, XunWei)}},
+    {u8"周而复始格", {eq(StemUpper, XunWei), eq(BranchUpper, XunShou)}},
+    {u8"回环格", {in(Initial, UpperSet), in(Middle, UpperSet), in(Final, UpperSet)}},
+    // 帘幕贵人高甲第
+    {u8"帘幕格", {fact(Daytime), eq(StemUpper, NightNoble)}},
+    {u8"帘幕格", {fact(Nighttime), eq(StemUpper, DayNoble)}},
+    {u8"斗鬼相加格", {eq(Palace, Wei), eq(StemUpper, Chou)}},
+    {u8"斗鬼相加格", {eq(Palace, Chou), eq(StemUpper, Wei)}},
+    {u8"斗鬼相加格", {eq(Birth, Wei), eq(above(Birth), Chou)}},
+    {u8"斗鬼相加格", {eq(Birth, Chou), eq(above(Birth), Wei)}},
+    {u8"亚魁星", {eq(StemUpper, You)}},
+    {u8"亚魁星", {eq(above(Birth), You)}},
+    {u8"德入天门格", {eq(Initial, De), eq(seat(De), Hai)}},
+    {u8"真朱雀格", {eq(ZhuQue, Wu), parent(Wu)}},
+    {u8"源消根断格", {generates(Stem, StemUpper), generates(StemUpper, StemYin),
+                      generates(Branch, BranchUpper), generates(BranchUpper, BranchYin)}},
+    // 催官使者赴官期
+    {u8"催官使者", {ghost(StemUpper), eq(BaiHu, StemUpper)}},
+    {u8"催官使者", {ghost(BaiHu), eq(BaiHu, above(Birth))}},
+    {u8"恩主举荐", {eq(Noble, StemGrowth)}},
+    // 六阳数足须公用，六阴相继尽昏迷
+    {u8"六阳格", {fact(AllYang)}},
+    {u8"悖戾格", {fact(AllYang), fact(BackwardGap)}},
+    {u8"五阳格", {fact(FiveYang), in(Birth, YangSet)}},
+    {u8"六阴格", {fact(AllYin)}},
+    {u8"五阴格", {fact(FiveYin), in(Birth, YinSet)}},
+    // 旺禄临身徒妄作，权摄不正禄临支
+    {u8"旺禄临身格", {eq(StemUpper, Lu)}},
+    {u8"禄被玄夺格", {eq(StemUpper, Lu), eq(XuanWu, Lu)}},
+    {u8"禄被玄夺格", {eq(StemUpper, Lu), eq(BaiHu, Lu)}},
+    {u8"日禄临支格", {eq(BranchUpper, Lu)}},
+    {u8"禄被支墓克脱", {eq(BranchUpper, Lu), overcomes(Branch, Lu)}},
+    {u8"禄被支墓克脱", {eq(BranchUpper, Lu), generates(Lu, Branch)}},
+    {u8"墓作太阳格", {eq(Sun, StemTomb), eq(StemUpper, Sun)}},
+    // 朽木难雕别作为
+    {u8"斫轮课", {eq(Initial, Mao), eq(seat(Mao), Shen)}},
+    {u8"朽木难雕格", {eq(Initial, Mao), eq(seat(Mao), Shen), isVoid(Mao)}},
+    {u8"斧斤不利格", {eq(Initial, Mao), eq(seat(Mao), Shen), isVoid(Shen)}},
+    // 众鬼虽彰全不畏
+    {u8"众鬼不惧格", {ghost(Initial), ghost(Middle), ghost(Final), child(StemUpper)}},
+    {u8"众鬼不惧格", {fact(Triad), ghost(Middle), child(StemUpper)}},
+    {u8"家鬼取家人", {ghost(BranchUpper), child(StemUpper)}},
+    {u8"家人解祸格", {ghost(Initial), ghost(Middle), ghost(Final), child(BranchUpper)}},
+    {u8"家人解祸格", {fact(Triad), ghost(Middle), child(BranchUpper)}},
+    {u8"引鬼为生格", {ghost(Initial), parent(Final)}},
+    {u8"传鬼为生格", {ghost(Initial), ghost(Middle), ghost(Final), parent(StemUpper)}},
+    {u8"传鬼为生格", {fact(Triad), ghost(Middle), parent(StemUpper)}},
+    {u8"贵德临身消除万祸格", {eq(StemUpper, Noble)}},
+    {u8"贵德临身消除万祸格", {eq(StemUpper, De)}},
+    // 虽忧狐假虎威仪
+    {u8"狐假虎威格", {overcomes(Palace, StemUpper)}},
+    // 传财太旺反财亏
+    // 连茹三传同在一方，方的五行即中传五行
+    {u8"进退连茹为财格", {fact(ForwardRu), wealth(Middle)}},
+    {u8"进退连茹为财格", {fact(BackwardRu), wealth(Middle)}},
+    {u8"财神空亡格", {wealth(StemUpper), isVoid(StemUpper)}},
+    {u8"财神空亡格", {wealth(BranchUpper), isVoid(BranchUpper)}},
+    // 脱上逢脱防虚诈
+    {u8"脱上脱格", {child(StemUpper), generatesGeneral(StemUpper)}},
+    {u8"无依脱耗格", {stemIn({3}), eq(Branch, Wei), fact(FanYinPlate)}},
+    {u8"脱盗格", {child(StemUpper), eq(XuanWu, StemUpper)}},
+    // 空上乘空事莫追
+    {u8"空上天空格", {isVoid(StemUpper), eq(TianKong, StemUpper)}},
+    {u8"脱空格", {child(StemUpper), eq(TianKong, StemUpper)}},
+    // 进茹空亡宜退步，踏脚空亡进用宜
+    {u8"进茹空亡格", {fact(ForwardRu), isVoid(Initial)}},
+    {u8"进茹空亡格", {fact(ForwardRu), isVoid(Middle)}},
+    {u8"进茹空亡格", {fact(ForwardRu), isVoid(Final)}},
+    {u8"退茹空亡格", {fact(BackwardRu), isVoid(Initial)}},
+    {u8"退茹空亡格", {fact(BackwardRu), isVoid(Middle)}},
+    {u8"退茹空亡格", {fact(BackwardRu), isVoid(Final)}},
+    {u8"寻死格", {parent(Initial), parent(Middle), parent(Final), isVoid(Initial)}},
+    {u8"寻死格", {parent(Initial), parent(Middle), parent(Final), isVoid(Middle)}},
+    {u8"寻死格", {parent(Initial), parent(Middle), parent(Final), isVoid(Final)}},
+    // 后一旬的空亡在本旬空亡前两位
+    {u8"踏脚空亡格", {isVoid(Initial), eq(Middle, Initial, -2), eq(Final, Initial, -4)}},
+    // 胎财生气妻怀孕
+    {u8"私孕格", {eq(XuanWu, StemTai)}},
+    {u8"互胎格", {eq(StemUpper, BranchTai), eq(BranchUpper, StemTai)}},
+    {u8"子恋母腹格", {eq(BranchUpper, Palace), eq(StemUpper, Branch), generates(Branch, Stem)}},
+    {u8"子恋母腹格", {eq(BranchUpper, Palace), eq(StemUpper, Branch), generates(Stem, Branch)}},
+    {u8"损孕格", {isVoid(StemTai)}},
+    {u8"胎神坐长生格", {eq(seat(StemTai), StemGrowth)}},
+    {u8"腹胎格", {eq(seat(Chou), StemTai)}},
+    {u8"腹空格", {isVoid(Chou)}},
+    {u8"全伤格", {overcomes(BranchUpper, Branch), overcomes(StemUpper, Stem)}},
+    {u8"夹定三传格", {eq(Initial, StemUpper, 1), eq(Final, BranchUpper, -1)}},
+    {u8"夹定三传格", {eq(Initial, StemUpper, -1), eq(Final, BranchUpper, 1)}},
+    // 交车相合交关利
+    {u8"交车长生", {eq(StemUpper, BranchGrowth), eq(BranchUpper, StemGrowth)}},
+    {u8"交车合财", {overcomes(Branch, StemUpper), overcomes(Stem, BranchUpper)}},
+    {u8"交车脱", {generates(Branch, StemUpper), generates(Stem, BranchUpper)}},
+    {u8"交车害", {harm(Palace, BranchUpper), harm(Branch, StemUpper)}},
+    {u8"交车刑", {punishes(StemUpper, Branch), punishes(BranchUpper, Palace)}},
+    {u8"交车冲", {eq(StemUpper, Branch, 6), eq(BranchUpper, Palace, 6)}},
+    {u8"交车克", {overcomes(StemUpper, Branch), overcomes(BranchUpper, Stem)}},
+    {u8"交车三合", {combine(StemUpper, Branch), combine(BranchUpper, Palace), fact(Triad)}},
+    // 上下皆合两心齐
+    {u8"上下俱合格", {combine(Palace, StemUpper), combine(Branch, BranchUpper)}},
+    {u8"干支相会格", {eq(StemUpper, Branch)}},
+    {u8"干支相会格", {eq(BranchUpper, Palace)}},
+    {u8"独支干上神作六合格", {combine(StemUpper, BranchUpper)}},
+    {u8"交互六合格", {combine(StemUpper, Branch), combine(BranchUpper, Palace)}},
+    {u8"外好里槎枒格", {combine(StemUpper, BranchUpper), harm(Palace, Branch)}},
+    // 彼求我事支传干，我求彼事干传支
+    {u8"支传干格", {eq(Initial, BranchUpper), eq(Final, StemUpper)}},
+    {u8"干传支格", {eq(Initial, StemUpper), eq(Final, BranchUpper)}},
+    // 金日逢丁凶祸动，水日逢丁财动之
+    {u8"金日逢丁格", {stemIn({6, 7}), eq(Initial, XunDing)}},
+    {u8"金日逢丁格", {stemIn({6, 7}), eq(Middle, XunDing)}},
+    {u8"金日逢丁格", {stemIn({6, 7}), eq(Final, XunDing)}},
+    {u8"金日逢丁格", {stemIn({6, 7}), eq(StemUpper, XunDing)}},
+    {u8"金日逢丁格", {stemIn({6, 7}), eq(BranchUpper, XunDing)}},
+    {u8"金日逢丁格", {stemIn({6, 7}), eq(above(Birth), XunDing)}},
+    {u8"蛇虎乘丁格", {eq(TengShe, XunDing)}},
+    {u8"蛇虎乘丁格", {eq(BaiHu, XunDing)}},
+    {u8"水日逢丁格", {stemIn({8, 9}), eq(Initial, XunDing)}},
+    {u8"水日逢丁格", {stemIn({8, 9}), eq(Middle, XunDing)}},
+    {u8"水日逢丁格", {stemIn({8, 9}), eq(Final, XunDing)}},
+    {u8"水日逢丁格", {stemIn({8, 9}), eq(StemUpper, XunDing)}},
+    {u8"水日逢丁格", {stemIn({8, 9}), eq(BranchUpper, XunDing)}},
+    {u8"水日逢丁格", {stemIn({8, 9}), eq(above(Birth), XunDing)}},
+    {u8"牛女相会格", {eq(seat(Zi), Chou), eq(TaiChang, Zi)}},
+    // 传财化鬼财休觅，传鬼化财钱险危
+    {u8"借钱还债格", {wealth(StemUpper), wealth(BranchUpper)}},
+    {u8"空财格", {wealth(StemUpper), isVoid(StemUpper)}},
+    {u8"危中取财格", {overcomes(Stem, Branch), ghost(BranchUpper)}},
+    // 眷属丰盈居狭宅，屋宅宽广致人衰
+    // 三传合局论局的五行，即中传五行
+    {u8"人胜宅格", {fact(Triad), parent(Middle), generates(Branch, Middle)}},
+    {u8"人旺弃宅格", {fact(Triad), parent(Middle), overcomes(Middle, Branch)}},
+    {u8"宅胜人格", {fact(Triad), child(Middle), generates(Middle, Branch)}},
+    // 三传递生人举荐，三传互克众人欺
+    {u8"递生格", {generates(Initial, Middle), generates(Middle, Final), generates(Final, Stem)}},
+    {u8"递生格", {generates(Final, Middle), generates(Middle, Initial), generates(Initial, Stem)}},
+    {u8"支干相生格", {generates(BranchUpper, StemUpper), generates(StemUpper, Stem)}},
+    {u8"两面刀格", {ghost(Final), parent(Initial)}},
+    {u8"递克格", {overcomes(Initial, Middle), overcomes(Middle, Final), overcomes(Final, Stem)}},
+    {u8"求财大获格", {wealth(Initial), overcomes(Initial, Middle), overcomes(Middle, Final)}},
+    {u8"雀鬼格", {eq(ZhuQue, StemUpper), ghost(StemUpper)}},
+    {u8"三传内战格", {overcomes(seat(Initial), Initial), overcomes(seat(Middle), Middle),
+                      overcomes(seat(Final), Final)}},
+    // 有始无终难变易
+    {u8"有始无终格", {eq(Initial, StemGrowth), eq(Final, StemTomb)}},
+    {u8"难变易格", {eq(Initial, StemTomb), eq(Final, StemGrowth)}},
+    {u8"恩多怨深格", {generates(Stem, Initial), generates(Initial, Middle), generates(Middle, Final),
+                      overcomes(Final, Stem)}},
+    {u8"不幸中幸格", {eq(BaiHu, StemGrowth)}},
+    {u8"幸中不幸格", {ghost(QingLong)}},
+    // 人宅受脱俱招盗
+    {u8"干支俱脱格", {child(StemUpper), generates(Branch, BranchUpper)}},
+    {u8"干支互脱格", {generates(Branch, StemUpper), generates(Stem, BranchUpper)}},
+    {u8"鬼脱乘玄格", {ghost(XuanWu)}},
+    {u8"鬼脱乘玄格", {child(XuanWu)}},
+    // 干支皆败势倾颓
+    {u8"干支皆败格", {eq(StemUpper, StemBath), eq(BranchUpper, BranchBath)}},
+    // 末助初兮三等论
+    {u8"末助初生干格", {generates(Final, Initial), parent(Initial)}},
+    {u8"末助初鬼格", {generates(Final, Initial), ghost(Initial)}},
+    {u8"末助初财格", {generates(Final, Initial), wealth(Initial)}},
+    {u8"抱鸡不斗格", {generates(Final, Initial), ghost(Initial), isVoid(Initial)}},
+    {u8"枉作恶人格", {generates(Final, Initial), ghost(Initial), isVoid(Final)}},
+    {u8"谒求祸出格", {wealth(BranchUpper), generates(BranchUpper, StemUpper), ghost(StemUpper)}},
+    {u8"自招其祸格", {generates(Birth, Initial), ghost(Initial)}},
+    // 闭口卦体两般推
+    {u8"闭口课", {eq(seat(XunWei), XunShou)}},
+    {u8"禄作闭口", {eq(Lu, XunWei), eq(seat(XunWei), XunShou)}},
+    // 太阳照武宜擒贼
+    {u8"太阳照武格", {eq(XuanWu, Sun)}},
+    {u8"天网四张格", {ghost(Initial), ghost(Hour)}},
+    {u8"贼向防连坐者", {combine(XuanWu, seat(XuanWu))}},
+    // 后合占婚岂用媒，富贵干支逢禄马
+    {u8"干支后合格", {eq(TianHou, StemUpper), eq(LiuHe, BranchUpper)}},
+    {u8"干支后合格", {eq(LiuHe, StemUpper), eq(TianHou, BranchUpper)}},
+    {u8"富贵课", {eq(StemUpper, Horse), eq(BranchUpper, Lu)}},
+    // 害贵讼直作曲断，昼夜贵加求两贵
+    {u8"贵害相加格", {overcomes(seat(Noble), Noble)}},
+    {u8"贵害相加格", {harm(seat(Noble), Noble)}},
+    {u8"贵覆干支格", {eq(StemUpper, DayNoble), eq(BranchUpper, NightNoble)}},
+    {u8"贵覆干支格", {eq(StemUpper, NightNoble), eq(BranchUpper, DayNoble)}},
+    {u8"贵人差迭格", {in(seat(DayNoble), NightSide), in(seat(NightNoble), DaySide)}},
+    // 贵虽在狱宜临干，鬼乘天乙乃神祇
+    {u8"贵人临身格", {eq(StemUpper, Noble), in(Palace, KuiGangSet)}},
+    {u8"贵人乘鬼临身格", {eq(StemUpper, Noble), ghost(Noble)}},
+    {u8"空亡贵人格", {isVoid(Noble)}},
+    {u8"贵人作墓格", {eq(Noble, StemTomb)}},
+    {u8"贵人脱气格", {child(Noble)}},
+    // 两贵受克难干贵
+    {u8"两贵受克格", {overcomes(seat(DayNoble), DayNoble), overcomes(seat(NightNoble), NightNoble)}},
+    {u8"贵人忌惮格", {overcomes(ZhuQue, Noble)}},
+    // 魁渡天门关隔定，罡塞鬼户任谋为
+    {u8"魁渡天门格", {eq(Initial, Xu), eq(seat(Xu), Hai)}},
+    {u8"罡塞鬼户格", {eq(seat(Chen), Yin)}},
+    {u8"贵塞鬼户格", {ghost(Initial), ghost(Middle), ghost(Final), eq(seat(Noble), Yin)}},
+    {u8"贵塞鬼户格", {fact(Triad), ghost(Middle), eq(seat(Noble), Yin)}},
+    {u8"神藏煞没格", {stemIn({0, 4, 6}), eq(seat(Chou), Hai)}},
+    {u8"神藏煞没格", {stemIn({0, 4, 6}), eq(seat(Wei), Hai)}},
+    // 两蛇夹墓凶难免，虎视逢虎力难施
+    {u8"两蛇夹墓格", {eq(TengShe, StemTomb), eq(seat(StemTomb), Si)}},
+    {u8"虎视逢虎格", {fact(HuShiPattern), eq(BaiHu, Initial)}},
+    {u8"虎视逢虎格", {fact(HuShiPattern), eq(BaiHu, Middle)}},
+    {u8"虎视逢虎格", {fact(HuShiPattern), eq(BaiHu, Final)}},
+    // 所谋多拙逢网罗，天网自裹己招非
+    {u8"天罗地网格", {eq(StemUpper, Palace, 1), eq(BranchUpper, Branch, 1)}},
+    {u8"天网自裹格", {eq(StemUpper, StemTomb), eq(Birth, StemTomb)}},
+    // 太阳射宅屋光辉
+    {u8"太阳射宅格", {eq(BranchUpper, Sun)}},
+    // 干乘墓虎无占病，支乘墓虎有伏尸
+    {u8"墓虎加干格", {eq(StemUpper, StemTomb), eq(BaiHu, StemTomb)}},
+    {u8"虎鬼加干格", {ghost(StemUpper), eq(BaiHu, StemUpper)}},
+    {u8"支乘墓虎格", {eq(BranchUpper, StemTomb), eq(BaiHu, BranchUpper)}},
+    {u8"支乘墓虎格", {eq(BranchUpper, BranchTomb), eq(BaiHu, BranchUpper)}},
+    {u8"虎鬼克支格", {eq(BaiHu, BranchUpper), overcomes(BranchUpper, Branch)}},
+    {u8"墓门开格", {eq(BranchUpper, StemTomb), eq(TengShe, StemTomb)}},
+    {u8"墓门开格", {eq(BranchUpper, StemTomb), eq(BaiHu, StemTomb)}},
+    {u8"蛇墓克支格", {eq(BranchUpper, StemTomb), eq(TengShe, StemTomb), overcomes(StemTomb, Branch)}},
+    // 彼此全伤防两损，夫妇芜淫各有私
+    {u8"芜淫卦", {overcomes(BranchUpper, Stem), overcomes(StemUpper, Branch)}},
+    // 支墓财并旅程稽，受虎克神为病症
+    {u8"支墓作财格", {wealth(BranchTomb)}},
+    {u8"虎鬼格", {ghost(BaiHu)}},
+    // 日禄临绝：刚日为返吟卦，柔日为绝体卦
+    {u8"绝体卦", {fact(YinDay), eq(seat(Lu), StemJue)}},
+    {u8"返吟卦", {fact(YangDay), eq(seat(Lu), StemJue)}},
+    {u8"绝嗣卦", {overcomes(StemUpper, Stem), overcomes(StemYin, StemUpper),
+                  overcomes(BranchUpper, Branch), overcomes(BranchYin, BranchUpper)}},
+    {u8"连茹卦", {fact(ForwardRu), wealth(Initial)}},
+    {u8"连茹卦", {fact(BackwardRu), wealth(Initial)}},
+    {u8"斫轮格", {eq(seat(Mao), Shen)}},
+    {u8"斫轮格", {eq(seat(Xu), Mao)}},
+    {u8"空禄格", {isVoid(Lu), overcomes(seat(Lu), Lu)}},
+    {u8"禄神闭口格", {eq(Lu, XunWei), eq(seat(XunWei), XunShou), eq(BaiHu, Lu)}},
+    {u8"白虎入丧车格", {eq(Initial, Shen), eq(seat(Shen), Si)}},
+    {u8"人入鬼门格", {stemIn({6}), fact(FanYinPlate), eq(Birth, Shen)}},
+    {u8"寒热格", {eq(seat(Si), Hai)}},
+    {u8"寒热格", {eq(seat(Si), Zi)}},
+    {u8"寒热格", {eq(seat(Wu), Hai)}},
+    {u8"寒热格", {eq(seat(Wu), Zi)}},
+    {u8"宴喜致病格", {eq(TaiChang, StemUpper), overcomes(StemUpper, Stem)}},
+    {u8"宴喜致病格", {eq(TaiChang, BranchUpper), overcomes(BranchUpper, Branch)}},
+    {u8"因妻致病格", {stemIn({6, 7}), ghost(XunDing)}},
+    // 鬼临三四讼灾随
+    {u8"救神临支格", {ghost(StemUpper), child(BranchUpper)}},
+    {u8"鬼临三四格", {ghost(BranchUpper)}},
+    {u8"鬼临三四格", {ghost(BranchYin)}},
+    {u8"朱勾相会格", {stemIn({2}), eq(Branch, Chen), eq(seat(Wu), Chen)}},
+    // 前后逼迫难进退
+    {u8"初传上下皆克格", {overcomes(seat(Initial), Initial), overcomes(above(Initial), Initial)}},
+    {u8"全伤坐克格", {overcomes(StemUpper, Stem), overcomes(BranchUpper, Branch),
+                      overcomes(seat(Palace), Palace), overcomes(seat(Branch), Branch)}},
+    // 空空如也事休追
+    {u8"三传皆空格", {isVoid(Initial), isVoid(Middle), isVoid(Final)}},
+    {u8"三传皆空格", {eq(TianKong, Initial), isVoid(Middle), isVoid(Final)}},
+    {u8"四课全空格", {isVoid(StemUpper), isVoid(StemYin), isVoid(BranchUpper), isVoid(BranchYin)}},
+    // 宾主不投刑在上
+    {u8"支上乘刑格", {in(StemUpper, SelfPunishSet), in(StemYin, SelfPunishSet),
+                      in(BranchUpper, SelfPunishSet), in(BranchYin, SelfPunishSet)}},
+    {u8"金刚格", {fact(MetalTriad), eq(StemUpper, You)}},
+    {u8"金刚格", {fact(MetalTriad), eq(BranchUpper, You)}},
+    {u8"火强格", {fact(FireTriad), eq(StemUpper, Wu)}},
+    {u8"火强格", {fact(FireTriad), eq(BranchUpper, Wu)}},
+    {u8"水流驱东格", {fact(WaterTriad), eq(StemUpper, Chen)}},
+    {u8"水流驱东格", {fact(WaterTriad), eq(BranchUpper, Chen)}},
+    {u8"木落归根格", {fact(WoodTriad), eq(StemUpper, Hai)}},
+    {u8"木落归根格", {fact(WoodTriad), eq(BranchUpper, Hai)}},
+    {u8"四胜煞格", {eq(StemUpper, You), eq(BranchUpper, Wu)}},
+    {u8"四胜煞格", {eq(StemUpper, Wu), eq(BranchUpper, You)}},
+    {u8"助刑戕德格", {punishes(Branch, Branch), ghost(Branch), eq(Initial, Branch)}},
+    {u8"助刑戕德格", {punishes(Branch, Branch), ghost(Branch), eq(Middle, Branch)}},
+    {u8"助刑戕德格", {punishes(Branch, Branch), ghost(Branch), eq(Final, Branch)}},
+    // 彼此猜忌害相随
+    {u8"彼此猜忌格", {harm(Palace, StemUpper), harm(Branch, BranchUpper)}},
+    {u8"人喜我忧格", {harm(Palace, StemUpper), combine(Branch, BranchUpper)}},
+    // 互生俱生凡事益，互旺皆旺坐谋宜
+    {u8"互生格", {generates(StemUpper, Branch), generates(BranchUpper, Stem)}},
+    {u8"俱生格", {generates(StemUpper, Stem), generates(BranchUpper, Branch)}},
+    {u8"互旺格", {eq(BranchUpper, StemProsper), eq(StemUpper, BranchProsper)}},
+    {u8"皆旺格", {eq(StemUpper, StemProsper), eq(BranchUpper, BranchProsper)}},
+    // 干支值绝凡谋决
+    {u8"支干乘绝格", {eq(StemUpper, StemJue), eq(BranchUpper, BranchJue)}},
+    {u8"绝神加生格", {eq(seat(StemJue), StemGrowth)}},
+    {u8"递互作绝神格", {eq(StemUpper, BranchJue), eq(BranchUpper, StemJue)}},
+    // 传墓入墓分憎爱，不行传者考初时
+    {u8"传墓入墓格", {eq(Middle, InitialTomb)}},
+    {u8"传墓入墓格", {eq(Final, InitialTomb)}},
+    {u8"不行传格", {isVoid(Middle), isVoid(Final)}},
+    {u8"独足卦", {eq(Initial, You), eq(Middle, You), eq(Final, You)}},
+    // 万事喜忻三六合，初遭夹克不由己
+    {u8"三六相呼格", {fact(Triad), combine(StemUpper, Initial)}},
+    {u8"三六相呼格", {fact(Triad), combine(StemUpper, Middle)}},
+    {u8"三六相呼格", {fact(Triad), combine(StemUpper, Final)}},
+    {u8"初遭夹克格", {overcomes(seat(Initial), Initial), generalOvercomes(Initial)}},
+    {u8"俯丘仰仇格", {eq(seat(Initial), InitialTomb), overcomes(above(Initial), Initial)}},
+    // 将逢内战所谋危：地盘克初传，初传克天将
+    {u8"天后内战格", {eq(TianHou, Initial), overcomes(seat(Initial), Initial),
+                      overcomesGeneral(Initial)}},
+    {u8"螣蛇内战格", {eq(TengShe, Initial), overcomes(seat(Initial), Initial),
+                      overcomesGeneral(Initial)}},
+    // 人宅坐墓甘招晦，干支乘墓各昏迷
+    {u8"干支坐墓格", {eq(seat(Palace), StemTomb), eq(seat(Branch), BranchTomb)}},
+    {u8"互坐丘墓格", {eq(seat(Palace), BranchTomb), eq(seat(Branch), StemTomb)}},
+    {u8"干支乘墓格", {eq(StemUpper, StemTomb), eq(BranchUpper, BranchTomb)}},
+    {u8"互乘墓神格", {eq(StemUpper, BranchTomb), eq(BranchUpper, StemTomb)}},
+    {u8"欲弃屋宇格", {eq(BranchUpper, Palace), generates(Branch, Stem)}},
+    // 任信丁马须言动，来去俱空岂动宜
+    {u8"任信丁马格", {fact(FuYinPlate), eq(Initial, Horse)}},
+    {u8"任信丁马格", {fact(FuYinPlate), eq(Middle, Horse)}},
+    {u8"任信丁马格", {fact(FuYinPlate), eq(Final, Horse)}},
+    {u8"来去格", {fact(FanYinPlate)}},
+    {u8"移远就近格", {eq(StemUpper, Chen), eq(QingLong, Chen)}},
+    {u8"移远就近格", {eq(StemUpper, Chen), eq(LiuHe, Chen)}},
+    {u8"德丧禄绝格", {fact(FanYinPlate), fact(YangDay)}},
+    {u8"似返吟卦", {stemIn({9}), eq(Branch, Wei), eq(Initial, Shen), eq(Middle, Yin),
+                    eq(Final, Shen)}},
+    // 虎临干鬼凶速速
+    {u8"虎临干鬼格", {ghost(StemUpper), eq(BaiHu, StemUpper)}},
+    {u8"虎临干鬼格", {ghost(BaiHu), eq(BaiHu, above(Birth))}},
+    // 喜惧空亡乃妙机
+    {u8"见生不生格", {isVoid(StemGrowth)}},
+    {u8"见生不生格", {overcomes(seat(StemGrowth), StemGrowth)}},
+    {u8"见财无财格", {wealth(Initial), isVoid(Initial)}},
+    {u8"见财无财格", {wealth(Initial), overcomes(seat(Initial), Initial)}},
+    {u8"见财无财格", {wealth(Initial), generates(Initial, seat(Initial))}},
+    {u8"长上灾凶格", {isVoid(StemGrowth)}},
+    // 六爻现卦防其克：三合局的五行即中传（子午卯酉）的五行
+    {u8"财爻现卦", {fact(Triad), wealth(Middle)}},
+    {u8"父母爻现卦", {fact(Triad), parent(Middle)}},
+    {u8"子息爻现卦", {fact(Triad), child(Middle)}},
+    {u8"官鬼爻现卦", {fact(Triad), ghost(Middle)}},
+    {u8"同类现卦", {fact(Triad), same(Middle, Stem)}},
+    {u8"三传内现类而传自墓克格", {eq(Initial, Wu), eq(Middle, Chou), eq(Final, Shen)}},
+    {u8"支干同类格", {same(Branch, Stem)}},
+    {u8"懒去取财格", {same(StemUpper, Stem)}},
+});
+
+// 行下标到格局编号：同名相邻的行共用一个编号
+inline constexpr auto rowIds = [] {
+  std::array<uint8_t, rows.size()> ids{};
+  int id = 0;
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    if (i && rows[i].name != rows[i - 1].name) {
+      ++id;
+    }
+    ids[i] = static_cast<uint8_t>(id);
+  }
+  return ids;
+}();
+
+} // namespace bifa_detail
+
+// 格局数
+inline constexpr std::size_t biFaCount = bifa_detail::rowIds.back() + 1;
+
+static_assert(biFaCount <= 256);
+
+// 格局名称，下标为格局编号（条件表中的次序）
+inline constexpr auto biFaNames = [] {
+  std::array<std::u8string_view, biFaCount> names{};
+  for (std::size_t i = 0; i < bifa_detail::rows.size(); ++i) {
+    names[bifa_detail::rowIds[i]] = bifa_detail::rows[i].name;
+  }
+  return names;
+}();
+
+inline constexpr auto biFaNameText = makeNameText<biFaNames>();
+
+// 按名称查格局编号，无此格局时为 biFaCount
+constexpr std::size_t biFaId(std::u8string_view name) {
+  std::size_t id = 0;
+  while (id < biFaCount && biFaNames[id] != name) {
+    ++id;
+  }
+  return id;
+}
+
+// 同名的行须相邻，否则同一格局会占两个编号
+static_assert([] {
+  for (std::size_t i = 0; i < biFaCount; ++i) {
+    for (std::size_t j = i + 1; j < biFaCount; ++j) {
+      if (biFaNames[i] == biFaNames[j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}());
+
+// 命中格局的集合，四个 64 位字，第 i 位为格局 i
+using BiFaSet = std::array<uint64_t, 4>;
+
+constexpr bool contains(const BiFaSet &set, std::size_t id) { return set[id >> 6] >> (id & 63) & 1; }
+
+// 按编号顺序对集合中的每个格局调用 f
+template <class F> constexpr void forEachBiFa(const BiFaSet &set, F &&f) {
+  for (std::size_t w = 0; w < set.size(); ++w) {
+    for (uint64_t bits = set[w]; bits; bits &= bits - 1) {
+      f(w * 64 + std::countr_zero(bits));
+    }
+  }
+}
+
+namespace bifa_detail {
+
+// 五行之长生：木亥、火寅、土申（随水）、金巳、水申；沐浴、帝旺、墓、绝、胎依次在其后 1、4、8、9、10 位
+inline constexpr std::array<uint8_t, 6> growthOf = {0, 11, 2, 8, 5, 8};
+
+// 日禄、日德，下标为天干
+inline constexpr std::array<uint8_t, 10> luOf = {2, 3, 5, 6, 5, 6, 8, 9, 11, 0};
+inline constexpr std::array<uint8_t, 10> deOf = {2, 8, 5, 11, 5, 2, 8, 5, 11, 5};
+
+// 驿马：申子辰马在寅，巳酉丑在亥，寅午戌在申，亥卯未在巳，下标为地支模 4
+inline constexpr std::array<uint8_t, 4> horseOf = {2, 11, 8, 5};
+
+constexpr uint16_t branchBits(std::initializer_list<int> branches) {
+  uint16_t bits = 0;
+  for (int b : branches) {
+    bits |= static_cast<uint16_t>(1u << b);
+  }
+  return bits;
+}
+
+// 三传的三合局：申子辰、寅午戌、亥卯未、巳酉丑
+inline constexpr std::array<uint16_t, 4> triadBits = {
+    branchBits({8, 0, 4}), branchBits({2, 6, 10}), branchBits({11, 3, 7}), branchBits({5, 9, 1})};
+
+inline constexpr uint8_t absent = 0xff;
+
+// 一课的共用事实。位置连同修饰一并展开，条件取值只需查表
+struct Facts {
+  std::array<uint8_t, 256> value;   // 各操作数（位置加修饰）的地支，缺为 absent
+  std::array<uint8_t, 256> element; // 各操作数的五行，日干不带修饰时取干的五行
+  std::array<uint8_t, 12> general;  // 天盘地支所乘天将
+  std::array<uint16_t, BranchSetCount> sets;
+  uint32_t facts;
+};
+
+constexpr Facts facts(const Chart &chart, std::optional<EarthlyBranch> birth) {
+  Facts f{};
+  int stem = chart.dayStem;
+  int branch = chart.dayBranch;
+  int palace = stemPalace(stem);
+  int rotation = wrap(chart.heavenPlate[0]);
+  int t0 = chart.transmissions[0];
+  int t1 = chart.transmissions[1];
+  int t2 = chart.transmissions[2];
+  int se = stemElement(stem);
+  int be = branchElement(branch);
+  int xunShou = wrap(branch - stem);
+
+  std::array<uint8_t, RoleCount> branches{};
+  auto put = [&](Role role, int b) { branches[role] = static_cast<uint8_t>(b); };
+  for (int b = 0; b < 12; ++b) {
+    put(static_cast<Role>(b), b);
+  }
+  for (int g = 0; g < 12; ++g) {
+    f.general[chart.generals[g]] = static_cast<uint8_t>(g);
+  }
+  put(Stem, palace);
+  put(Palace, palace);
+  put(Branch, branch);
+  put(StemUpper, static_cast<int>(chart.upper(0)));
+  put(StemYin, static_cast<int>(chart.upper(1)));
+  put(BranchUpper, static_cast<int>(chart.upper(2)));
+  put(BranchYin, static_cast<int>(chart.upper(3)));
+  put(Initial, t0);
+  put(Middle, t1);
+  put(Final, t2);
+  put(Hour, chart.hourBranch);
+  put(Sun, chart.moonGeneral);
+  put(Noble, chart.generals[0]);
+  put(DayNoble, static_cast<int>(getNoble(static_cast<HeavenlyStem>(stem), true)));
+  put(NightNoble, static_cast<int>(getNoble(static_cast<HeavenlyStem>(stem), false)));
+  for (int g = 1; g < 12; ++g) {
+    put(static_cast<Role>(TengShe + g - 1), chart.generals[g]);
+  }
+  put(XunShou, xunShou);
+  put(XunWei, wrap(xunShou + 9));
+  put(XunDing, wrap(xunShou + 3));
+  put(Lu, luOf[stem]);
+  put(De, deOf[stem]);
+  put(Horse, horseOf[branch % 4]);
+  int sg = growthOf[se];
+  int bg = growthOf[be];
+  put(StemGrowth, sg);
+  put(StemBath, wrap(sg + 1));
+  put(StemProsper, wrap(sg + 4));
+  put(StemTomb, wrap(sg + 8));
+  put(StemJue, wrap(sg + 9));
+  put(StemTai, wrap(sg + 10));
+  put(BranchGrowth, bg);
+  put(BranchBath, wrap(bg + 1));
+  put(BranchProsper, wrap(bg + 4));
+  put(BranchTomb, wrap(bg + 8));
+  put(BranchJue, wrap(bg + 9));
+  put(BranchTai, wrap(bg + 10));
+  put(InitialTomb, wrap(growthOf[branchElement(t0)] + 8));
+  put(Birth, birth ? static_cast<int>(*birth) : absent);
+  f.value.fill(absent);
+  for (int r = 0; r < RoleCount; ++r) {
+    int b = branches[r];
+    if (b == absent) {
+      continue;
+    }
+    int seated = wrap(b - rotation);
+    int upper = chart.heavenPlate[b];
+    f.value[r] = static_cast<uint8_t>(b);
+    f.value[r | seatBit] = static_cast<uint8_t>(seated);
+    f.value[r | aboveBit] = static_cast<uint8_t>(upper);
+    f.element[r] = static_cast<uint8_t>(branchElement(b));
+    f.element[r | seatBit] = static_cast<uint8_t>(branchElement(seated));
+    f.element[r | aboveBit] = static_cast<uint8_t>(branchElement(upper));
+  }
+  f.element[Stem] = static_cast<uint8_t>(se);
+
+  uint16_t trans = static_cast<uint16_t>(1u << t0 | 1u << t1 | 1u << t2);
+  uint16_t uppers = 0;
+  int yang = (t0 % 2 == 0) + (t1 % 2 == 0) + (t2 % 2 == 0);
+  for (int i = 0; i < 4; ++i) {
+    int upper = static_cast<int>(chart.upper(i));
+    uppers |= static_cast<uint16_t>(1u << upper);
+    yang += upper % 2 == 0;
+  }
+  f.sets[VoidSet] = branchBits({wrap(xunShou + 10), wrap(xunShou + 11)});
+  f.sets[UpperSet] = uppers;
+  f.sets[YangSet] = branchBits({0, 2, 4, 6, 8, 10});
+  f.sets[YinSet] = branchBits({1, 3, 5, 7, 9, 11});
+  f.sets[DaySide] = branchBits({3, 4, 5, 6, 7, 8});
+  f.sets[NightSide] = branchBits({9, 10, 11, 0, 1, 2});
+  f.sets[KuiGangSet] = branchBits({4, 10});
+  f.sets[SelfPunishSet] = branchBits({4, 6, 9, 11});
+
+  auto setFact = [&](Fact which, bool value) {
+    f.facts |= static_cast<uint32_t>(value) << which;
+  };
+  setFact(FuYinPlate, rotation == 0);
+  setFact(FanYinPlate, rotation == 6);
+  setFact(YangDay, stem % 2 == 0);
+  setFact(YinDay, stem % 2 == 1);
+  setFact(Daytime, chart.isDay());
+  setFact(Nighttime, !chart.isDay());
+  setFact(AllYang, yang == 7);
+  setFact(AllYin, yang == 0);
+  setFact(FiveYang, yang == 5);
+  setFact(FiveYin, yang == 2);
+  setFact(ForwardRu, t1 == wrap(t0 + 1) && t2 == wrap(t1 + 1));
+  setFact(BackwardRu, t1 == wrap(t0 - 1) && t2 == wrap(t1 - 1));
+  setFact(BackwardGap, t1 == wrap(t0 - 2) && t2 == wrap(t1 - 2));
+  for (int i = 0; i < 4; ++i) {
+    setFact(Triad, trans == triadBits[i]);
+    setFact(static_cast<Fact>(WaterTriad + i), trans == triadBits[i]);
+  }
+  setFact(HuShiPattern,
+          chart.patterns[0] == ChartPattern::HuShi || chart.patterns[1] == ChartPattern::HuShi);
+  return f;
+}
+
+constexpr bool test(const Facts &f, const Cond &c, int stem) {
+  switch (c.op) {
+  case Op::None:
+    return true;
+  case Op::Fact:
+    return f.facts >> c.b & 1;
+  case Op::StemIn:
+    return c.b >> stem & 1;
+  default:
+    break;
+  }
+  int a = f.value[c.a];
+  if (a == absent) {
+    return false;
+  }
+  int ea = f.element[c.a];
+  switch (c.op) {
+  case Op::In:
+    return f.sets[c.b] >> a & 1;
+  case Op::GeneralOvercomes:
+    return chart_detail::overcomes(generalFiveElements[f.general[a]], ea);
+  case Op::OvercomesGeneral:
+    return chart_detail::overcomes(ea, generalFiveElements[f.general[a]]);
+  case Op::GeneratesGeneral:
+    return ::generate(ea, generalFiveElements[f.general[a]]);
+  default:
+    break;
+  }
+  int b = f.value[c.b];
+  if (b == absent) {
+    return false;
+  }
+  int eb = f.element[c.b];
+  switch (c.op) {
+  case Op::Eq:
+    return a == wrap(b + c.k);
+  case Op::Same:
+    return ea == eb;
+  case Op::Generates:
+    return ::generate(ea, eb);
+  case Op::Overcomes:
+    return chart_detail::overcomes(ea, eb);
+  case Op::Combine:
+    return wrap(a + b) == 1;
+  case Op::Harm:
+    return wrap(a + b) == 7;
+  case Op::Punish:
+    return punishment(a) == b;
+  default:
+    return false;
+  }
+}
+
+} // namespace bifa_detail
+
+// 课盘命中的全部毕法格局。课盘须含四课、三传与天将（参见 ChartFieldMask）；
+// birth 为本命地支，未给出时涉及本命的条件不成立
+constexpr BiFaSet classifyBiFa(const Chart &chart, std::optional<EarthlyBranch> birth = {}) {
+  using namespace bifa_detail;
+  Facts f = facts(chart, birth);
+  BiFaSet set{};
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    std::size_t id = rowIds[i];
+    if (contains(set, id)) {
+      continue;
+    }
+    bool hit = true;
+    for (const Cond &c : rows[i].conds) {
+      if (c.op == Op::None) {
+        break;
+      }
+      if (!test(f, c, chart.dayStem)) {
+        hit = false;
+        break;
+      }
+    }
+    set[id >> 6] |= static_cast<uint64_t>(hit) << (id & 63);
+  }
+  return set;
+}
+
+// 查表求不计本命的格局，与 classifyBiFa(chart) 相同。表按日干支、天盘旋转与占时索引，
+// 首次调用时生成
+const BiFaSet &lookupBiFa(const Chart &chart);
+
+// 成批判定：out[i] 为 charts[i] 的格局集合。births 为空时不计本命，否则与 charts 等长，
+// 元素为本命地支，0xff 表示未知；未知本命的课盘走查表。
+// out 短于 charts 或 births 非空而与 charts 不等长时抛出 std::invalid_argument
+void classifyBiFaBatch(std::span<const Chart> charts, std::span<BiFaSet> out,
+                       std::span<const uint8_t> births = {});
+
+#endif // DA_LIU_REN_BIFA_HPP
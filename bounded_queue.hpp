@@ -0,0 +1,52 @@
+//
+// 有界阻塞队列：批处理流水线与守护进程的线程间交接
+//
+
+#ifndef DA_LIU_REN_BOUNDED_QUEUE_HPP
+#define DA_LIU_REN_BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// 有界阻塞队列，满时 push 等待，关闭且取空后 pop 返回空
+template <class T> class BoundedQueue {
+public:
+  explicit BoundedQueue(std::size_t capacity) : capacity(capacity) {}
+
+  void push(T value) {
+    std::unique_lock lock(mutex);
+    notFull.wait(lock, [&] { return items.size() < capacity; });
+    items.push_back(std::move(value));
+    notEmpty.notify_one();
+  }
+
+  std::optional<T> pop() {
+    std::unique_lock lock(mutex);
+    notEmpty.wait(lock, [&] { return !items.empty() || closed; });
+    if (items.empty()) {
+      return std::nullopt;
+    }
+    T value = std::move(items.front());
+    items.pop_front();
+    notFull.notify_one();
+    return value;
+  }
+
+  void close() {
+    std::lock_guard lock(mutex);
+    closed = true;
+    notEmpty.notify_all();
+  }
+
+private:
+  std::size_t capacity;
+  std::deque<T> items;
+  bool closed = false;
+  std::mutex mutex;
+  std::condition_variable notFull, notEmpty;
+};
+
+#endif // DA_LIU_REN_BOUNDED_QUEUE_HPP
@@ -0,0 +1,130 @@
+//
+// 百年普查：排出 1900.1.31~2100.12.31 每个时辰的课盘，统计格局、课体、毕法、贵人、初传等分布
+//
+
+#include "bifa.hpp"
+#include "course_table.hpp"
+#include "lesson_types.hpp"
+#include "lunar.h"
+#include "work_stealing.hpp"
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// 每块的天数
+constexpr int32_t daysPerChunk = 64;
+
+// 各线程的局部统计，独占缓存行避免伪共享
+struct alignas(64) Census {
+  uint64_t charts = 0;
+  std::array<uint64_t, chartPatternNames.size()> pattern{};
+  std::array<uint64_t, lessonTypeNames.size()> lessonType{};
+  std::array<uint64_t, biFaCount> biFa{};
+  std::array<uint64_t, 12> noble{};      // 贵人所临地支
+  std::array<uint64_t, 12> initial{};    // 初传地支
+  std::array<uint64_t, 12> moonGeneral{};
+  uint64_t clockwise = 0;
+  uint64_t daytime = 0;
+
+  void add(const Chart &chart) {
+    ++charts;
+    for (ChartPattern p : chart.patterns) {
+      if (p != ChartPattern::None) {
+        ++pattern[static_cast<int>(p)];
+      }
+    }
+    for (LessonTypeSet types = classifyLessonTypes(chart); types; types &= types - 1) {
+      ++lessonType[std::countr_zero(types)];
+    }
+    forEachBiFa(lookupBiFa(chart), [&](std::size_t id) { ++biFa[id]; });
+    ++noble[chart.generals[0]];
+    ++initial[chart.transmissions[0]];
+    ++moonGeneral[chart.moonGeneral];
+    clockwise += (chart.flags & ChartClockwise) != 0;
+    daytime += chart.isDay();
+  }
+
+  void merge(const Census &other) {
+    charts += other.charts;
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+      pattern[i] += other.pattern[i];
+    }
+    for (std::size_t i = 0; i < lessonType.size(); ++i) {
+      lessonType[i] += other.lessonType[i];
+    }
+    for (std::size_t i = 0; i < biFa.size(); ++i) {
+      biFa[i] += other.biFa[i];
+    }
+    for (int i = 0; i < 12; ++i) {
+      noble[i] += other.noble[i];
+      initial[i] += other.initial[i];
+      moonGeneral[i] += other.moonGeneral[i];
+    }
+    clockwise += other.clockwise;
+    daytime += other.daytime;
+  }
+};
+
+void printBranchHistogram(std::string_view title, const std::array<uint64_t, 12> &counts) {
+  fmt::print("{}:\n", title);
+  for (int b = 0; b < 12; ++b) {
+    fmt::print("  {} {}\n", branchNameText[b], counts[b]);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 0;
+  int32_t days = Lunar::dayNumber(2100, 12, 31) + 1;
+  std::size_t chunks = static_cast<std::size_t>((days + daysPerChunk - 1) / daysPerChunk);
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<Census> partial(threads == 0 ? std::max(1u, std::thread::hardware_concurrency())
+                                           : threads);
+  forEachChunk(chunks, static_cast<unsigned>(partial.size()), [&](unsigned worker, std::size_t chunk) {
+    Census &census = partial[worker];
+    int32_t first = static_cast<int32_t>(chunk) * daysPerChunk;
+    int32_t last = std::min(first + daysPerChunk, days);
+    for (int32_t n = first; n < last; ++n) {
+      Pillar day = dayPillar(n);
+      EarthlyBranch moonGeneral = getMoonGeneral(Lunar::dayInfo(n)->lunarMonth);
+      for (EarthlyBranch hour : earthPlateData) {
+        census.add(lookupChart(day.stem, day.branch, moonGeneral, hour));
+      }
+    }
+  });
+  Census total;
+  for (const Census &census : partial) {
+    total.merge(census);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  fmt::print("课盘数: {}（{} 日，{} 线程，{:.3f} 秒）\n", total.charts, days, partial.size(),
+             elapsed.count());
+  fmt::print("昼占: {} 夜占: {} 天将顺布: {} 逆布: {}\n", total.daytime,
+             total.charts - total.daytime, total.clockwise, total.charts - total.clockwise);
+  fmt::print("格局:\n");
+  for (std::size_t p = 1; p < total.pattern.size(); ++p) {
+    fmt::print("  {} {}\n", chartPatternNameText[p], total.pattern[p]);
+  }
+  fmt::print("课体:\n");
+  for (std::size_t t = 0; t < total.lessonType.size(); ++t) {
+    fmt::print("  {} {}\n", lessonTypeNameText[t], total.lessonType[t]);
+  }
+  fmt::print("毕法:\n");
+  for (std::size_t id = 0; id < total.biFa.size(); ++id) {
+    fmt::print("  {} {}\n", biFaNameText[id], total.biFa[id]);
+  }
+  printBranchHistogram("贵人", total.noble);
+  printBranchHistogram("初传", total.initial);
+  printBranchHistogram("月将", total.moonGeneral);
+  return 0;
+}
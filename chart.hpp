@@ -0,0 +1,490 @@
+//
+// 紧凑课盘：可平凡复制的 Chart 与单趟排盘内核 computeChart，不分配内存
+//
+
+#ifndef DA_LIU_REN_CHART_HPP
+#define DA_LIU_REN_CHART_HPP
+
+#include "common.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+// 三传取法格局
+enum class ChartPattern : uint8_t {
+  None,
+  ChongShen,    // 重审卦：下贼上
+  YuanShou,     // 元首卦：上克下
+  ZhiYi,        // 知一卦：比用
+  SheHai,       // 涉害卦
+  JianJi,       // 见机卦：涉害相等取孟上
+  ChaWei,       // 察微卦：涉害相等取仲上
+  FuDeng,       // 复等卦：刚日干上、柔日支上
+  YaoKe,        // 遥克卦
+  HuShi,        // 虎视卦：刚日昴星
+  DongSheYanMu, // 冬蛇掩目：柔日昴星
+  BieZe,        // 别责卦
+  BaZhuan,      // 八专卦
+  FuYinGui,     // 伏吟六癸日
+  FuYinYi,      // 伏吟六乙日
+  FuYinGang,    // 伏吟刚日
+  FuYinRou,     // 伏吟柔日
+  WuQin,        // 无亲卦：返吟无克，驿马发用
+};
+
+// 格局名称
+inline constexpr std::array<std::u8string_view, 18> chartPatternNames = {
+    u8"",         u8"重审卦", u8"元首卦", u8"知一卦",
+    u8"涉害卦",   u8"见机卦", u8"察微卦", u8"复等卦",
+    u8"遥克卦",   u8"虎视卦", u8"冬蛇掩目", u8"别责卦",
+    u8"八专卦",   u8"自信卦 - 伏吟 - 六癸日", u8"自信卦 - 伏吟 - 六乙日",
+    u8"自任卦 - 伏吟 - 刚日", u8"自信卦 - 伏吟 - 柔日", u8"无亲卦"};
+
+inline constexpr auto chartPatternNameText = makeNameText<chartPatternNames>();
+
+constexpr std::u8string_view nameOf(ChartPattern pattern) {
+  return chartPatternNames[static_cast<int>(pattern)];
+}
+
+constexpr std::string_view textOf(ChartPattern pattern) {
+  return chartPatternNameText[static_cast<int>(pattern)];
+}
+
+// Chart::flags 的位
+enum ChartFlags : uint8_t {
+  ChartDaytime = 1 << 0,   // 昼占，用昼贵
+  ChartClockwise = 1 << 1, // 天将顺布
+};
+
+// 课盘的组成部分，按位组合为 ChartFieldMask。只需部分字段的调用方声明所需，
+// 未请求的部分不计算，对应字段保持为 0
+enum ChartField : uint16_t {
+  ChartFieldPillar = 1 << 0,        // 日干支、月将、占时，总会给出
+  ChartFieldPlate = 1 << 1,         // 天盘
+  ChartFieldLessons = 1 << 2,       // 四课
+  ChartFieldTransmissions = 1 << 3, // 三传
+  ChartFieldPatterns = 1 << 4,      // 取传格局
+  ChartFieldNoble = 1 << 5,         // 贵人（generals[0]）、昼夜与天将顺逆（flags）
+  ChartFieldGenerals = 1 << 6,      // 十二天将
+  ChartFieldLessonTypes = 1 << 7,   // 课体，由其余各部分判定（参见 lesson_types.hpp）
+  ChartFieldBiFa = 1 << 8,          // 毕法格局，由其余各部分判定（参见 bifa.hpp）
+  ChartFieldShenSha = 1 << 9,       // 十二宫神煞，不在课盘内，由 chartAt 另行求出（参见 shen_sha.hpp）
+};
+
+using ChartFieldMask = uint16_t;
+
+inline constexpr ChartFieldMask chartFieldsAll = 0x3ff;
+
+// 课盘本身所含的部分
+inline constexpr ChartFieldMask chartFieldsInChart = chartFieldsAll & ~ChartFieldShenSha;
+
+// 补全依赖：课体与毕法格局依赖其余各部分；三传与格局出自同一趟取传，取传依赖四课，四课依赖天盘；
+// 天将依赖贵人
+constexpr ChartFieldMask withDependencies(ChartFieldMask fields) {
+  if (fields & (ChartFieldLessonTypes | ChartFieldBiFa)) {
+    fields |= chartFieldsInChart;
+  }
+  if (fields & (ChartFieldTransmissions | ChartFieldPatterns)) {
+    fields |= ChartFieldTransmissions | ChartFieldPatterns | ChartFieldLessons;
+  }
+  if (fields & ChartFieldLessons) {
+    fields |= ChartFieldPlate;
+  }
+  if (fields & ChartFieldGenerals) {
+    fields |= ChartFieldNoble;
+  }
+  return static_cast<ChartFieldMask>((fields & chartFieldsAll) | ChartFieldPillar);
+}
+
+// 一张课盘，所有字段为 uint8_t 编码的枚举值
+struct Chart {
+  uint8_t dayStem;                      // 日干
+  uint8_t dayBranch;                    // 日支
+  uint8_t moonGeneral;                  // 月将
+  uint8_t hourBranch;                   // 占时
+  std::array<uint8_t, 12> heavenPlate;  // 地盘宫位 -> 所临天盘地支
+  std::array<uint8_t, 12> generals;     // 十二神将（贵人起）所乘天盘地支
+  std::array<uint8_t, 4> lessons;       // 四课：高 4 位为下（第一课为日干），低 4 位为上神
+  std::array<uint8_t, 3> transmissions; // 初传、中传、末传
+  std::array<ChartPattern, 2> patterns; // 取传格局，遥克再入比用时占两项
+  uint8_t flags;                        // ChartFlags 位组合
+
+  constexpr EarthlyBranch upper(int lesson) const {
+    return static_cast<EarthlyBranch>(lessons[lesson] & 0x0f);
+  }
+  constexpr int lower(int lesson) const { return lessons[lesson] >> 4; }
+  constexpr EarthlyBranch initial() const {
+    return static_cast<EarthlyBranch>(transmissions[0]);
+  }
+  constexpr EarthlyBranch middle() const {
+    return static_cast<EarthlyBranch>(transmissions[1]);
+  }
+  constexpr EarthlyBranch finalTransmission() const {
+    return static_cast<EarthlyBranch>(transmissions[2]);
+  }
+  constexpr bool isDay() const { return flags & ChartDaytime; }
+};
+
+static_assert(std::is_trivially_copyable_v<Chart>);
+static_assert(sizeof(Chart) <= 40);
+
+namespace chart_detail {
+
+// 以整数编码访问 common.hpp 中的表
+constexpr uint8_t stemElement(int stem) {
+  return static_cast<uint8_t>(heavenlyStemFiveElements[stem]);
+}
+constexpr uint8_t branchElement(int branch) {
+  return static_cast<uint8_t>(earthlyBranchFiveElements[branch]);
+}
+constexpr uint8_t stemPalace(int stem) {
+  return static_cast<uint8_t>(palaceTable[stem]);
+}
+constexpr int punishment(int branch) {
+  return static_cast<int>(conflictTable[branch]);
+}
+
+constexpr int wrap(int branch) { return (branch % 12 + 12) % 12; }
+
+// 五行 x 克 y；Work::overcome 会遮蔽全局的 overcome
+constexpr bool overcomes(int x, int y) { return overcome(x, y); }
+
+constexpr bool isMeng(int branch) { return branch % 3 == 2; }  // 寅巳申亥
+constexpr bool isZhong(int branch) { return branch % 3 == 0; } // 子卯午酉
+
+// 涉害深度表 [上神][所临宫位][0 贼 / 1 克]：上神自所临宫位顺行归本家，
+// 沿途地盘支与寄宫干的克数。贼取克上神者，克取上神所克者
+inline constexpr auto harmDepthTable = [] {
+  std::array<std::array<std::array<uint8_t, 2>, 12>, 12> table{};
+  for (int u = 0; u < 12; ++u) {
+    int e = branchElement(u);
+    for (int start = 0; start < 12; ++start) {
+      for (int b = start; b != u; b = wrap(b + 1)) {
+        auto add = [&](int other) {
+          table[u][start][0] += overcomes(other, e);
+          table[u][start][1] += overcomes(e, other);
+        };
+        add(branchElement(b));
+        for (int s = 0; s < 10; ++s) {
+          if (stemPalace(s) == b) {
+            add(stemElement(s));
+          }
+        }
+      }
+    }
+  }
+  return table;
+}();
+
+// 四课集合以 4 位掩码表示，第 i 位为第 i 课
+using LessonMask = uint8_t;
+
+// 掩码中最低位的课
+constexpr int firstLesson(LessonMask mask) { return std::countr_zero(mask); }
+
+// 排盘过程中的中间量
+struct Work {
+  Chart &chart;
+  int rotation;                  // 天盘相对地盘的旋转
+  std::array<uint8_t, 4> palace; // 四课下神所在地盘宫位
+  std::array<uint8_t, 4> lowerElement;
+  LessonMask thiefMask = 0;      // 下贼上之课
+  LessonMask overcomeMask = 0;   // 上克下之课
+  uint16_t palaceMask = 0;       // 四课下神所占地盘宫位，位数即不同课数
+
+  constexpr int upper(int i) const { return chart.lessons[i] & 0x0f; }
+  constexpr int upperElement(int i) const { return branchElement(upper(i)); }
+  constexpr int plate(int branch) const { return chart.heavenPlate[wrap(branch)]; }
+  constexpr bool yangDay() const { return chart.dayStem % 2 == 0; }
+  constexpr bool thief(int i) const { return thiefMask >> i & 1; }
+
+  // 一次求出贼、克与宫位掩码
+  constexpr void analyzeLessons() {
+    for (int i = 0; i < 4; ++i) {
+      palaceMask |= static_cast<uint16_t>(1u << palace[i]);
+      thiefMask |= static_cast<LessonMask>(
+          overcomes(lowerElement[i], upperElement(i)) << i);
+      overcomeMask |= static_cast<LessonMask>(
+          overcomes(upperElement(i), lowerElement[i]) << i);
+    }
+  }
+
+  // 集合内同一宫位只保留首次出现的课
+  constexpr LessonMask distinct(LessonMask set) const {
+    LessonMask result = 0;
+    uint16_t seen = 0;
+    for (LessonMask m = set; m; m &= m - 1) {
+      int i = firstLesson(m);
+      uint16_t bit = static_cast<uint16_t>(1u << palace[i]);
+      result |= static_cast<LessonMask>(!(seen & bit) << i);
+      seen |= bit;
+    }
+    return result;
+  }
+
+  // 不同的课数，四课不备时小于 4
+  constexpr int distinctLessons() const { return std::popcount(palaceMask); }
+
+  constexpr void transmit(int initial, int middle, int last, ChartPattern p) {
+    chart.transmissions = {static_cast<uint8_t>(wrap(initial)),
+                           static_cast<uint8_t>(wrap(middle)),
+                           static_cast<uint8_t>(wrap(last))};
+    chart.patterns[chart.patterns[0] == ChartPattern::None ? 0 : 1] = p;
+  }
+
+  // 初传定后，中传取初传上神，末传取中传上神
+  constexpr void transmitFrom(int initial, ChartPattern p) {
+    int middle = plate(initial);
+    transmit(initial, middle, plate(middle), p);
+  }
+
+  // 涉害深度，查 harmDepthTable
+  constexpr int harmDepth(int i) const {
+    return harmDepthTable[upper(i)][palace[i]][thief(i) ? 0 : 1];
+  }
+
+  // 涉害法
+  constexpr void harmInvolved(LessonMask set) {
+    int depth[4] = {};
+    int maxDepth = 0;
+    for (LessonMask m = set; m; m &= m - 1) {
+      int i = firstLesson(m);
+      depth[i] = harmDepth(i);
+      maxDepth = depth[i] > maxDepth ? depth[i] : maxDepth;
+    }
+    LessonMask deepest = 0, meng = 0, zhong = 0;
+    for (LessonMask m = set; m; m &= m - 1) {
+      int i = firstLesson(m);
+      if (depth[i] == maxDepth) {
+        deepest |= static_cast<LessonMask>(1u << i);
+        meng |= static_cast<LessonMask>(isMeng(palace[i]) << i);
+        zhong |= static_cast<LessonMask>(isZhong(palace[i]) << i);
+      }
+    }
+    if (std::popcount(deepest) == 1) {
+      transmitFrom(upper(firstLesson(deepest)), ChartPattern::SheHai);
+    } else if (meng) {
+      // 涉害相等，先取孟上，再取仲上
+      transmitFrom(upper(firstLesson(meng)), ChartPattern::JianJi);
+    } else if (zhong) {
+      transmitFrom(upper(firstLesson(zhong)), ChartPattern::ChaWei);
+    } else {
+      // 刚日取干上神，柔日取支上神
+      transmitFrom(yangDay() ? upper(0) : upper(2), ChartPattern::FuDeng);
+    }
+  }
+
+  // 比用法：取与日干阴阳相同的上神
+  constexpr void comparisonUse(LessonMask set) {
+    LessonMask same = 0;
+    for (LessonMask m = set; m; m &= m - 1) {
+      int i = firstLesson(m);
+      same |= static_cast<LessonMask>((upper(i) % 2 == chart.dayStem % 2) << i);
+    }
+    if (std::popcount(same) == 1) {
+      transmitFrom(upper(firstLesson(same)), ChartPattern::ZhiYi);
+    } else {
+      harmInvolved(same == 0 ? set : same);
+    }
+  }
+
+  // 单课直接发用，多课入比用
+  constexpr void useLessons(LessonMask set, ChartPattern single) {
+    if (std::popcount(set) == 1) {
+      transmitFrom(upper(firstLesson(set)), single);
+    } else {
+      comparisonUse(set);
+    }
+  }
+
+  // 贼克法（含比用、涉害）
+  constexpr bool thiefConquer() {
+    if (LessonMask set = distinct(thiefMask)) {
+      useLessons(set, ChartPattern::ChongShen);
+      return true;
+    }
+    if (LessonMask set = distinct(overcomeMask)) {
+      useLessons(set, ChartPattern::YuanShou);
+      return true;
+    }
+    return false;
+  }
+
+  constexpr bool isEightSpecialDay() const {
+    return stemPalace(chart.dayStem) == chart.dayBranch;
+  }
+
+  // 遥克法：先取克日之上神（蒿矢），无则取日所克之上神（弹射）
+  constexpr bool remoteOvercome() {
+    if (isEightSpecialDay()) {
+      return false;
+    }
+    int dayElement = stemElement(chart.dayStem);
+    LessonMask overcomesDay = 0, overcomedByDay = 0;
+    for (int i = 1; i < 4; ++i) {
+      overcomesDay |= static_cast<LessonMask>(overcomes(upperElement(i), dayElement) << i);
+      overcomedByDay |= static_cast<LessonMask>(overcomes(dayElement, upperElement(i)) << i);
+    }
+    LessonMask set = distinct(overcomesDay ? overcomesDay : overcomedByDay);
+    if (set == 0) {
+      return false;
+    }
+    if (std::popcount(set) > 1) {
+      chart.patterns[0] = ChartPattern::YaoKe;
+    }
+    useLessons(set, ChartPattern::YaoKe);
+    return true;
+  }
+
+  // 昴星法：四课全备时，刚日取酉上神，柔日取酉下神
+  constexpr bool angStar() {
+    if (distinctLessons() != 4) {
+      return false;
+    }
+    if (yangDay()) {
+      transmit(plate(9), upper(2), upper(0), ChartPattern::HuShi);
+    } else {
+      transmit(9 - rotation, upper(0), upper(2), ChartPattern::DongSheYanMu);
+    }
+    return true;
+  }
+
+  // 别责法：三课备时，刚日取干合上神，柔日取支前三合
+  constexpr bool specialResponsibility() {
+    if (distinctLessons() != 3) {
+      return false;
+    }
+    int initial = yangDay() ? plate(stemPalace((chart.dayStem + 5) % 10))
+                            : chart.dayBranch + 4;
+    transmit(initial, upper(0), upper(0), ChartPattern::BieZe);
+    return true;
+  }
+
+  // 八专法：刚日干上神顺数三位，柔日第四课上神逆数三位
+  constexpr bool eightSpecial() {
+    if (!isEightSpecialDay()) {
+      return false;
+    }
+    int initial = yangDay() ? upper(0) + 2 : upper(3) - 2;
+    transmit(initial, upper(0), upper(0), ChartPattern::BaZhuan);
+    return true;
+  }
+
+  // 伏吟：取刑，自刑则取冲或另一阳神
+  constexpr void staticChant() {
+    auto punish = [](int branch, int fallback) {
+      int p = punishment(branch);
+      return p == branch ? fallback : p;
+    };
+    if (chart.dayStem == 9) {
+      transmit(plate(1), 10, 7, ChartPattern::FuYinGui);
+    } else if (chart.dayStem == 1) {
+      int middle = upper(2);
+      transmit(4, middle, punish(middle, wrap(middle + 6)), ChartPattern::FuYinYi);
+    } else {
+      bool yang = yangDay();
+      int initial = yang ? upper(0) : upper(2);
+      int middle = punish(initial, yang ? upper(2) : upper(0));
+      transmit(initial, middle, punish(middle, wrap(middle + 6)),
+               yang ? ChartPattern::FuYinGang : ChartPattern::FuYinRou);
+    }
+  }
+
+  // 返吟：有克用贼克，无克以支驿马发用
+  constexpr void reverseChant() {
+    if (thiefConquer()) {
+      return;
+    }
+    int branch = chart.dayBranch;
+    while (!isMeng(branch)) {
+      branch = wrap(branch + 4);
+    }
+    transmit(branch + 6, upper(2), upper(0), ChartPattern::WuQin);
+  }
+
+  // 取三传：伏吟、返吟单独处理，其余依次尝试各法，返回 false 表示该法不适用
+  constexpr bool selectTransmissions() {
+    if (rotation == 0) {
+      staticChant();
+      return true;
+    }
+    if (rotation == 6) {
+      reverseChant();
+      return true;
+    }
+    constexpr bool (Work::*methods[])() = {
+        &Work::thiefConquer, &Work::remoteOvercome, &Work::angStar,
+        &Work::specialResponsibility, &Work::eightSpecial};
+    for (auto method : methods) {
+      if ((this->*method)()) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+} // namespace chart_detail
+
+// 排盘：月将加占时得天盘，立四课，取三传，布十二天将
+// fields 为所需部分，依赖由 withDependencies 补全
+constexpr Chart computeChart(HeavenlyStem dayStem, EarthlyBranch dayBranch,
+                             EarthlyBranch moonGeneral, EarthlyBranch hourBranch,
+                             ChartFieldMask fields = chartFieldsAll) {
+  using namespace chart_detail;
+  fields = withDependencies(fields);
+  Chart chart{};
+  int stem = static_cast<int>(dayStem);
+  int branch = static_cast<int>(dayBranch);
+  int hour = static_cast<int>(hourBranch);
+  int rotation = wrap(static_cast<int>(moonGeneral) - hour);
+
+  chart.dayStem = static_cast<uint8_t>(stem);
+  chart.dayBranch = static_cast<uint8_t>(branch);
+  chart.moonGeneral = static_cast<uint8_t>(moonGeneral);
+  chart.hourBranch = static_cast<uint8_t>(hour);
+  if (fields & ChartFieldPlate) {
+    for (int p = 0; p < 12; ++p) {
+      chart.heavenPlate[p] = static_cast<uint8_t>(wrap(p + rotation));
+    }
+  }
+
+  if (fields & ChartFieldLessons) {
+    // 四课：干上、干上之上、支上、支上之上
+    Work work{chart, rotation, {}, {}};
+    int u0 = chart.heavenPlate[stemPalace(stem)];
+    int u2 = chart.heavenPlate[branch];
+    work.palace = {stemPalace(stem), static_cast<uint8_t>(u0),
+                   static_cast<uint8_t>(branch), static_cast<uint8_t>(u2)};
+    work.lowerElement = {stemElement(stem), branchElement(u0), branchElement(branch),
+                         branchElement(u2)};
+    chart.lessons = {static_cast<uint8_t>(stem << 4 | u0),
+                     static_cast<uint8_t>(u0 << 4 | chart.heavenPlate[u0]),
+                     static_cast<uint8_t>(branch << 4 | u2),
+                     static_cast<uint8_t>(u2 << 4 | chart.heavenPlate[u2])};
+    work.analyzeLessons();
+    if (fields & ChartFieldTransmissions) {
+      work.selectTransmissions();
+    }
+  }
+
+  if (fields & ChartFieldNoble) {
+    // 贵人：卯至申为昼；贵人临亥至辰顺布，余逆布
+    bool isDay = hour >= 3 && hour <= 8;
+    int noble = static_cast<int>(getNoble(static_cast<HeavenlyStem>(stem), isDay));
+    bool clockwise = isNobleClockwise(static_cast<HeavenlyStem>(stem), isDay);
+    chart.generals[0] = static_cast<uint8_t>(noble);
+    if (fields & ChartFieldGenerals) {
+      for (int i = 1; i < 12; ++i) {
+        chart.generals[i] = static_cast<uint8_t>(wrap(noble + (clockwise ? i : -i)));
+      }
+    }
+    chart.flags = static_cast<uint8_t>((isDay ? ChartDaytime : 0) |
+                                       (clockwise ? ChartClockwise : 0));
+  }
+  return chart;
+}
+
+#endif // DA_LIU_REN_CHART_HPP
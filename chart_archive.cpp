@@ -0,0 +1,222 @@
+#include "chart_archive.hpp"
+#include "course_table.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::endian::native == std::endian::little, "存档按小端读写");
+
+namespace {
+
+constexpr std::array<char, 8> archiveMagic = {'D', 'L', 'R', 'C', 'H', 'A', 'R', 'T'};
+
+// 列在行组中的跨度，按 64 字节对齐
+constexpr uint64_t columnStride(uint64_t rows) { return (rows + 63) / 64 * 64; }
+
+// 各列取值的上界（不含），下标为 ArchiveColumn
+constexpr std::array<unsigned, archiveColumnCount> columnLimits = {
+    60, 12, 12, 12, 12, 12, chartPatternNames.size(), chartPatternNames.size(), 12,
+    (ChartDaytime | ChartClockwise) + 1};
+
+[[noreturn]] void fail(const char *what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+} // namespace
+
+ChartArchiveWriter::ChartArchiveWriter(const std::string &path, uint32_t rowsPerGroup)
+    : file(std::fopen(path.c_str(), "wb")), rowsPerGroup(rowsPerGroup ? rowsPerGroup : 1) {
+  if (file == nullptr) {
+    fail("ChartArchiveWriter: fopen");
+  }
+  // 先写占位文件头，close 时回填
+  ArchiveHeader header{};
+  if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+    fail("ChartArchiveWriter: fwrite");
+  }
+  for (auto &column : columns) {
+    column.reserve(this->rowsPerGroup);
+  }
+}
+
+ChartArchiveWriter::~ChartArchiveWriter() {
+  if (file != nullptr) {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+}
+
+void ChartArchiveWriter::append(std::span<const Chart> charts) {
+  for (const Chart &chart : charts) {
+    uint8_t values[archiveColumnCount] = {
+        static_cast<uint8_t>(pillarIndex({static_cast<HeavenlyStem>(chart.dayStem),
+                                          static_cast<EarthlyBranch>(chart.dayBranch)})),
+        chart.heavenPlate[0],
+        chart.hourBranch,
+        chart.transmissions[0],
+        chart.transmissions[1],
+        chart.transmissions[2],
+        static_cast<uint8_t>(chart.patterns[0]),
+        static_cast<uint8_t>(chart.patterns[1]),
+        chart.generals[0],
+        chart.flags};
+    for (std::size_t c = 0; c < archiveColumnCount; ++c) {
+      columns[c].push_back(values[c]);
+    }
+    ++rowCount;
+    if (columns[0].size() == rowsPerGroup) {
+      flushGroup();
+    }
+  }
+}
+
+void ChartArchiveWriter::flushGroup() {
+  uint64_t rows = columns[0].size();
+  if (rows == 0) {
+    return;
+  }
+  static constexpr uint8_t padding[64] = {};
+  uint64_t stride = columnStride(rows);
+  for (auto &column : columns) {
+    if (std::fwrite(column.data(), 1, rows, file) != rows ||
+        std::fwrite(padding, 1, stride - rows, file) != stride - rows) {
+      fail("ChartArchiveWriter: fwrite");
+    }
+    column.clear();
+  }
+  index.push_back(position);
+  index.push_back(rows);
+  position += stride * archiveColumnCount;
+}
+
+void ChartArchiveWriter::close() {
+  if (file == nullptr) {
+    return;
+  }
+  flushGroup();
+  ArchiveHeader header{};
+  header.magic = archiveMagic;
+  header.version = archiveVersion;
+  header.rowsPerGroup = rowsPerGroup;
+  header.rowCount = rowCount;
+  header.groupCount = index.size() / 2;
+  header.indexOffset = position;
+  std::FILE *f = std::exchange(file, nullptr);
+  bool ok = std::fwrite(index.data(), sizeof(uint64_t), index.size(), f) == index.size() &&
+            std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, f) == 1;
+  ok = std::fclose(f) == 0 && ok;
+  if (!ok) {
+    fail("ChartArchiveWriter: close");
+  }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+ChartArchive::ChartArchive(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    fail("ChartArchive: open");
+  }
+  struct stat st;
+  if (::fstat(fd, &st) < 0) {
+    int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "ChartArchive: fstat");
+  }
+  length = static_cast<std::size_t>(st.st_size);
+  void *mapped = length ? ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+  int error = errno;
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    throw std::system_error(length ? error : EINVAL, std::generic_category(), "ChartArchive: mmap");
+  }
+  data = static_cast<const uint8_t *>(mapped);
+
+  // 校验文件头与行组索引，之后的访问不再检查边界
+  const ArchiveHeader &h = header();
+  bool valid = length >= sizeof(ArchiveHeader) && h.magic == archiveMagic &&
+               h.version == archiveVersion && h.rowsPerGroup > 0 &&
+               h.indexOffset <= length && h.groupCount <= (length - h.indexOffset) / 16;
+  const uint64_t *index = reinterpret_cast<const uint64_t *>(data + h.indexOffset);
+  uint64_t rows = 0;
+  for (uint64_t g = 0; valid && g < h.groupCount; ++g) {
+    uint64_t offset = index[2 * g], count = index[2 * g + 1];
+    valid = count <= h.rowsPerGroup && offset <= h.indexOffset &&
+            columnStride(count) * archiveColumnCount <= h.indexOffset - offset &&
+            (g + 1 == h.groupCount || count == h.rowsPerGroup);
+    rows += count;
+  }
+  valid = valid && rows == h.rowCount;
+  // 逐列检查取值范围，chart() 据此直接查 720 课表
+  for (uint64_t g = 0; valid && g < h.groupCount; ++g) {
+    ArchiveRowGroup rowGroup = group(static_cast<std::size_t>(g));
+    for (std::size_t c = 0; valid && c < archiveColumnCount; ++c) {
+      valid = std::all_of(rowGroup.columns[c].begin(), rowGroup.columns[c].end(),
+                          [limit = columnLimits[c]](uint8_t v) { return v < limit; });
+    }
+  }
+  if (!valid) {
+    ::munmap(const_cast<uint8_t *>(data), length);
+    data = nullptr;
+    throw std::runtime_error("ChartArchive: 文件格式不符");
+  }
+}
+
+ChartArchive::~ChartArchive() {
+  if (data != nullptr) {
+    ::munmap(const_cast<uint8_t *>(data), length);
+  }
+}
+
+#else
+
+ChartArchive::ChartArchive(const std::string &) {
+  throw std::runtime_error("ChartArchive: 当前平台不支持 mmap");
+}
+
+ChartArchive::~ChartArchive() = default;
+
+#endif
+
+ChartArchive::ChartArchive(ChartArchive &&other) noexcept
+    : data(std::exchange(other.data, nullptr)), length(std::exchange(other.length, 0)) {}
+
+ArchiveRowGroup ChartArchive::group(std::size_t g) const {
+  const uint64_t *index = reinterpret_cast<const uint64_t *>(data + header().indexOffset);
+  uint64_t offset = index[2 * g], rows = index[2 * g + 1];
+  ArchiveRowGroup result{static_cast<std::size_t>(rows), {}};
+  for (std::size_t c = 0; c < archiveColumnCount; ++c) {
+    result.columns[c] = {data + offset + c * columnStride(rows), static_cast<std::size_t>(rows)};
+  }
+  return result;
+}
+
+Chart ChartArchive::chart(uint64_t row) const {
+  if (row >= size()) {
+    throw std::out_of_range("ChartArchive::chart: 行号越界");
+  }
+  ArchiveRowGroup rows = group(static_cast<std::size_t>(row / header().rowsPerGroup));
+  std::size_t i = static_cast<std::size_t>(row % header().rowsPerGroup);
+  auto value = [&](ArchiveColumn c) { return rows.column(c)[i]; };
+  if (static_cast<ChartPattern>(value(ArchiveColumn::Pattern)) == ChartPattern::None) {
+    return Chart{};
+  }
+  Pillar day = pillarOf(value(ArchiveColumn::DayPillar));
+  int hour = value(ArchiveColumn::HourBranch);
+  return lookupChart(day.stem, day.branch,
+                     static_cast<EarthlyBranch>((hour + value(ArchiveColumn::Rotation)) % 12),
+                     static_cast<EarthlyBranch>(hour));
+}
@@ -0,0 +1,113 @@
+//
+// 课盘列式存档：按行组存放各列，写入端流式追加，读取端 mmap 后直接给出各列的只读视图
+//
+// 文件布局（整数均为小端）：
+//   文件头 64 字节：魔数 "DLRCHART"、版本、每行组行数、总行数、行组数、行组索引偏移
+//   行组：各列依次存放，每列 rows 字节，按 64 字节对齐
+//   行组索引：每个行组的起始偏移（uint64）与行数（uint64）
+//
+
+#ifndef DA_LIU_REN_CHART_ARCHIVE_HPP
+#define DA_LIU_REN_CHART_ARCHIVE_HPP
+
+#include "chart.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+// 存档的列，每列每行 1 字节
+enum class ArchiveColumn : uint8_t {
+  DayPillar,     // 日干支序号 0~59
+  Rotation,      // 天盘旋转（子上神），即月将减占时
+  HourBranch,    // 占时
+  Initial,       // 初传
+  Middle,        // 中传
+  Final,         // 末传
+  Pattern,       // 取传格局
+  SecondPattern, // 遥克再入比用等第二格局，无则为 None
+  Noble,         // 贵人所临地支，配合 Flags 中的顺逆即得十二天将位置
+  Flags,         // ChartFlags
+};
+
+inline constexpr std::size_t archiveColumnCount = 10;
+inline constexpr uint32_t archiveVersion = 1;
+
+// 文件头
+struct ArchiveHeader {
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t rowsPerGroup;
+  uint64_t rowCount;
+  uint64_t groupCount;
+  uint64_t indexOffset;
+  std::array<uint8_t, 24> reserved;
+};
+
+static_assert(sizeof(ArchiveHeader) == 64);
+
+// 流式写入：攒满一个行组即写出，close 时写行组索引并回填文件头。出错时抛出 std::system_error
+class ChartArchiveWriter {
+public:
+  explicit ChartArchiveWriter(const std::string &path, uint32_t rowsPerGroup = 1 << 16);
+  ChartArchiveWriter(const ChartArchiveWriter &) = delete;
+  ChartArchiveWriter &operator=(const ChartArchiveWriter &) = delete;
+  ~ChartArchiveWriter();
+
+  // 追加课盘；无法起课的项可传 Chart{}（格局为 None）以保持行号对齐
+  void append(std::span<const Chart> charts);
+  // 写出剩余行与索引并关闭文件；析构时若未关闭会自动调用，但不再报告错误
+  void close();
+
+  uint64_t rows() const { return rowCount; }
+
+private:
+  void flushGroup();
+
+  std::FILE *file;
+  uint32_t rowsPerGroup;
+  uint64_t rowCount = 0;
+  uint64_t position = sizeof(ArchiveHeader); // 下一行组的写入偏移
+  std::array<std::vector<uint8_t>, archiveColumnCount> columns;
+  std::vector<uint64_t> index; // 各行组的偏移与行数交替存放
+};
+
+// 一个行组各列的只读视图
+struct ArchiveRowGroup {
+  std::size_t rows;
+  std::array<std::span<const uint8_t>, archiveColumnCount> columns;
+
+  std::span<const uint8_t> column(ArchiveColumn c) const {
+    return columns[static_cast<int>(c)];
+  }
+};
+
+// 以 mmap 打开存档，列视图直接指向映射内存。打开时校验文件头、行组索引与各列取值范围，
+// 格式不符时抛出 std::runtime_error
+class ChartArchive {
+public:
+  explicit ChartArchive(const std::string &path);
+  ChartArchive(ChartArchive &&other) noexcept;
+  ChartArchive(const ChartArchive &) = delete;
+  ChartArchive &operator=(const ChartArchive &) = delete;
+  ~ChartArchive();
+
+  uint64_t size() const { return header().rowCount; }
+  uint64_t groupCount() const { return header().groupCount; }
+  ArchiveRowGroup group(std::size_t g) const;
+  // 由各列与 720 课表还原第 row 行的完整课盘；row 不小于 size() 时抛出 std::out_of_range
+  Chart chart(uint64_t row) const;
+
+private:
+  const ArchiveHeader &header() const {
+    return *reinterpret_cast<const ArchiveHeader *>(data);
+  }
+
+  const uint8_t *data = nullptr;
+  std::size_t length = 0;
+};
+
+#endif // DA_LIU_REN_CHART_ARCHIVE_HPP
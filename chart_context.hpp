@@ -0,0 +1,108 @@
+//
+// 分层上下文：年、月、日三层各放只随该粒度变化的量，分层只为结构清楚；各层的量都是查表所得，
+// 逐日重建并不昂贵。同一日各时辰共享日层，只需查课表
+//
+
+#ifndef DA_LIU_REN_CHART_CONTEXT_HPP
+#define DA_LIU_REN_CHART_CONTEXT_HPP
+
+#include "course_table.hpp"
+#include "lunar.h"
+#include "pillar.hpp"
+#include "shen_sha.hpp"
+#include <array>
+#include <cstdint>
+#include <optional>
+
+// 农历年层
+struct YearContext {
+  int32_t lunarYear;
+  uint8_t leapMonth; // 闰几月，0 为无闰月
+};
+
+// 农历月层：月将随农历月取
+struct MonthContext {
+  YearContext year;
+  uint8_t lunarMonth;
+  bool isLeap;
+  EarthlyBranch moonGeneral;
+};
+
+// 日层：农历信息、年月日三柱、日干寄宫与昼夜贵人；各时辰的课盘由 chart(hour) 派生
+struct DayContext {
+  MonthContext month;
+  LunarDate date;
+  int32_t dayNumber; // 距 1900.1.31 的天数
+  Pillar yearPillar;
+  Pillar monthPillar;
+  Pillar dayPillar;
+  EarthlyBranch stemPalace;
+  EarthlyBranch dayNoble;
+  EarthlyBranch nightNoble;
+
+  // 四柱，时柱由日干按五鼠遁推出
+  FourPillars pillars(int hour) const {
+    return {yearPillar, monthPillar, dayPillar, hourPillar(dayPillar.stem, hour)};
+  }
+
+  // 当日十二宫神煞，由太岁、月建与日柱三张预计算表按宫相或
+  ShenShaPlate shenSha() const {
+    return computeShenSha(yearPillar.branch, monthPillar.branch, dayPillar);
+  }
+
+  EarthlyBranch noble(int hour) const {
+    return isDaytime(hourBranchOf(hour)) ? dayNoble : nightNoble;
+  }
+
+  // 某钟点（0~23）的课盘，只查 720 课表
+  Chart chart(int hour) const {
+    return lookupChart(dayPillar.stem, dayPillar.branch, month.moonGeneral, hourBranchOf(hour));
+  }
+
+  // 十二时辰的课盘，依次为子时至亥时
+  std::array<Chart, 12> hourCharts() const {
+    std::array<Chart, 12> charts;
+    for (int b = 0; b < 12; ++b) {
+      charts[b] = lookupChart(dayPillar.stem, dayPillar.branch, month.moonGeneral,
+                              static_cast<EarthlyBranch>(b));
+    }
+    return charts;
+  }
+};
+
+inline YearContext yearContext(int32_t lunarYear) {
+  Lunar lunar;
+  return {lunarYear, static_cast<uint8_t>(lunar.leapMonth(lunarYear))};
+}
+
+inline MonthContext monthContext(const YearContext &year, int lunarMonth, bool isLeap) {
+  return {year, static_cast<uint8_t>(lunarMonth), isLeap, getMoonGeneral(lunarMonth)};
+}
+
+// 由农历信息建日层
+inline DayContext dayContext(const LunarDate &date) {
+  MonthContext month = monthContext(yearContext(date.lunarYear), date.lunarMonth, date.isLeap);
+  FourPillars pillars = fourPillars(date, 0);
+  HeavenlyStem stem = pillars.day.stem;
+  return {month,
+          date,
+          Lunar::dayNumber(date.solarYear, date.solarMonth, date.solarDay),
+          pillars.year,
+          pillars.month,
+          pillars.day,
+          getPalace(stem),
+          getNoble(stem, true),
+          getNoble(stem, false)};
+}
+
+// 由公历日期建日层，超出 1900.1.31~2100.12.31 时为空
+inline std::optional<DayContext> dayContext(int32_t year, int32_t month, int32_t day) {
+  Lunar lunar;
+  std::optional<LunarDate> date = lunar.solar2lunarDate(year, month, day);
+  if (!date) {
+    return std::nullopt;
+  }
+  return dayContext(*date);
+}
+
+#endif // DA_LIU_REN_CHART_CONTEXT_HPP
@@ -0,0 +1,210 @@
+#include "chart_format.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+namespace {
+
+using Out = std::back_insert_iterator<fmt::memory_buffer>;
+
+std::string_view branchText(int branch) { return branchNameText[branch]; }
+
+} // namespace
+
+bool parseChartInput(std::string_view line, ChartInput &input) {
+  // '@' 之后为本命生年，只含数字，前后可有空白
+  std::optional<int64_t> birthYear;
+  if (std::size_t at = line.find('@'); at != std::string_view::npos) {
+    std::string_view text = line.substr(at + 1);
+    std::size_t begin = text.find_first_not_of(" \t\r");
+    std::size_t end = text.find_last_not_of(" \t\r");
+    if (begin == std::string_view::npos) {
+      return false;
+    }
+    int64_t year = 0;
+    for (char c : text.substr(begin, end - begin + 1)) {
+      if (c < '0' || c > '9') {
+        return false;
+      }
+      year = year * 10 + (c - '0');
+      if (year > INT32_MAX) {
+        return false;
+      }
+    }
+    birthYear = year;
+    line = line.substr(0, at);
+  }
+  int64_t fields[4] = {};
+  int count = 0;
+  bool inNumber = false;
+  for (char c : line) {
+    if (c >= '0' && c <= '9') {
+      if (!inNumber) {
+        if (count == 4) {
+          break;
+        }
+        inNumber = true;
+        ++count;
+      }
+      int64_t &field = fields[count - 1];
+      field = field * 10 + (c - '0');
+      if (field > INT32_MAX) {
+        return false;
+      }
+    } else if (c == ' ' || c == '\t' || c == ',' || c == '-' || c == 'T' || c == ':' ||
+               c == '/' || c == '\r') {
+      inNumber = false;
+    } else {
+      return false;
+    }
+  }
+  if (count < 4 || fields[1] > 255 || fields[2] > 255 || fields[3] > 255) {
+    return false;
+  }
+  input = {static_cast<int32_t>(fields[0]), static_cast<uint8_t>(fields[1]),
+           static_cast<uint8_t>(fields[2]), static_cast<uint8_t>(fields[3])};
+  if (birthYear) {
+    // 甲子年（公元 4 年）起子
+    input.birth = static_cast<uint8_t>((*birthYear + 8) % 12);
+  }
+  return true;
+}
+
+bool parseChartFields(std::string_view list, ChartFieldMask &fields) {
+  static constexpr std::pair<std::string_view, ChartFieldMask> names[] = {
+      {"pillar", ChartFieldPillar},   {"plate", ChartFieldPlate},
+      {"lessons", ChartFieldLessons}, {"transmissions", ChartFieldTransmissions},
+      {"patterns", ChartFieldPatterns}, {"noble", ChartFieldNoble},
+      {"generals", ChartFieldGenerals}, {"types", ChartFieldLessonTypes},
+      {"bifa", ChartFieldBiFa},       {"shensha", ChartFieldShenSha},
+      {"all", chartFieldsAll}};
+  ChartFieldMask result = 0;
+  while (!list.empty()) {
+    std::size_t comma = list.find(',');
+    std::string_view name = list.substr(0, comma);
+    auto it = std::find_if(std::begin(names), std::end(names),
+                           [&](const auto &entry) { return entry.first == name; });
+    if (it == std::end(names)) {
+      return false;
+    }
+    result |= it->second;
+    list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+  }
+  fields = result;
+  return true;
+}
+
+void writeChartJson(fmt::memory_buffer &buffer, const ChartRequest &request,
+                    const std::optional<Chart> &chart, ChartFieldMask fields,
+                    const ShenShaPlate *shenSha) {
+  Out out(buffer);
+  if (!request.valid || !chart) {
+    fmt::format_to(out, R"({{"line":{},"error":"{}"}})"
+                        "\n",
+                   request.line, request.valid ? "out of range" : "invalid input");
+    return;
+  }
+  const ChartInput &in = request.input;
+  out = fmt::format_to(out, R"({{"line":{},"date":"{:04}-{:02}-{:02}","hour":{},)", request.line,
+                       in.year, in.month, in.day, in.hour);
+  if (in.birth < 12) {
+    out = fmt::format_to(out, R"("birth":"{}",)", branchText(in.birth));
+  }
+  out = formatChartFields(out, *chart, fields, in.birthBranch());
+  if ((fields & ChartFieldShenSha) && shenSha != nullptr) {
+    *out++ = ',';
+    out = formatShenSha(out, *shenSha);
+  }
+  *out++ = '}';
+  *out++ = '\n';
+}
+
+void writeChartRecord(fmt::memory_buffer &buffer, const ChartRequest &request,
+                      const std::optional<Chart> &chart, ChartFieldMask, const ShenShaPlate *) {
+  if (!request.valid || !chart) {
+    std::fill_n(Out(buffer), chartRecordSize, '\0');
+    return;
+  }
+  formatChartBinary(Out(buffer), *chart);
+}
+
+std::optional<Chart> parseChartBinary(std::span<const uint8_t, chartRecordSize> record) {
+  if (record[0] != chartRecordVersion) {
+    return std::nullopt;
+  }
+  Chart chart{};
+  const uint8_t *p = record.data() + 1;
+  chart.dayStem = *p++;
+  chart.dayBranch = *p++;
+  chart.moonGeneral = *p++;
+  chart.hourBranch = *p++;
+  std::copy_n(p, 12, chart.heavenPlate.begin());
+  p += 12;
+  std::copy_n(p, 12, chart.generals.begin());
+  p += 12;
+  std::copy_n(p, 4, chart.lessons.begin());
+  p += 4;
+  std::copy_n(p, 3, chart.transmissions.begin());
+  p += 3;
+  for (ChartPattern &pattern : chart.patterns) {
+    if (*p >= chartPatternNames.size()) {
+      return std::nullopt;
+    }
+    pattern = static_cast<ChartPattern>(*p++);
+  }
+  chart.flags = *p;
+  // 各地支字段须小于 12；四课上神为地支，第一课下为日干，其余下为地支；flags 只含已定义的位
+  auto isBranch = [](uint8_t b) { return b < 12; };
+  bool valid = chart.dayStem < 10 && isBranch(chart.dayBranch) && isBranch(chart.moonGeneral) &&
+               isBranch(chart.hourBranch) && std::ranges::all_of(chart.heavenPlate, isBranch) &&
+               std::ranges::all_of(chart.generals, isBranch) &&
+               std::ranges::all_of(chart.transmissions, isBranch) &&
+               (chart.flags & ~(ChartDaytime | ChartClockwise)) == 0;
+  for (int i = 0; valid && i < 4; ++i) {
+    valid = static_cast<int>(chart.upper(i)) < 12 && chart.lower(i) < (i == 0 ? 10 : 12);
+  }
+  return valid ? std::optional(chart) : std::nullopt;
+}
+
+void writeChartCsv(fmt::memory_buffer &buffer, const ChartRequest &request,
+                   const std::optional<Chart> &chart, ChartFieldMask fields, const ShenShaPlate *) {
+  Out out(buffer);
+  if (!request.valid || !chart) {
+    fmt::format_to(out, "{},,,,,,,,,,,,,,,,,{}\n", request.line,
+                   request.valid ? "out of range" : "invalid input");
+    return;
+  }
+  const ChartInput &in = request.input;
+  const Chart &c = *chart;
+  fmt::format_to(out, "{},{:04}-{:02}-{:02},{},{}{},{},{},", request.line, in.year, in.month,
+                 in.day, in.hour, stemNameText[c.dayStem], branchText(c.dayBranch),
+                 branchText(c.moonGeneral), branchText(c.hourBranch));
+  if (fields & ChartFieldNoble) {
+    fmt::format_to(out, "{}", c.isDay());
+  }
+  for (int i = 0; i < 4; ++i) {
+    if (fields & ChartFieldLessons) {
+      std::string_view lower = i == 0 ? stemNameText[c.lower(0)] : branchText(c.lower(i));
+      fmt::format_to(out, ",{}/{}", lower, branchText(static_cast<int>(c.upper(i))));
+    } else {
+      *out++ = ',';
+    }
+  }
+  if (fields & ChartFieldTransmissions) {
+    fmt::format_to(out, ",{},{},{},", branchText(c.transmissions[0]),
+                   branchText(c.transmissions[1]), branchText(c.transmissions[2]));
+  } else {
+    fmt::format_to(out, ",,,,");
+  }
+  for (int i = 0; i < 2 && (fields & ChartFieldPatterns) && c.patterns[i] != ChartPattern::None;
+       ++i) {
+    fmt::format_to(out, "{}{}", i ? "|" : "", textOf(c.patterns[i]));
+  }
+  if (fields & ChartFieldNoble) {
+    fmt::format_to(out, ",{},{},\n", branchText(c.generals[0]), (c.flags & ChartClockwise) != 0);
+  } else {
+    fmt::format_to(out, ",,,\n");
+  }
+}
@@ -0,0 +1,307 @@
+//
+// 课盘序列化：完整课盘的 JSON 与定长二进制记录，以及批处理、守护进程的行格式。
+// 模板版本写入任意输出迭代器，名称直接复制静态表中的字节，不产生临时字符串
+//
+
+#ifndef DA_LIU_REN_CHART_FORMAT_HPP
+#define DA_LIU_REN_CHART_FORMAT_HPP
+
+#include "batch.hpp"
+#include "bifa.hpp"
+#include "chart_generals.hpp"
+#include "lesson_types.hpp"
+#include "shen_sha.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <fmt/format.h>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace chart_format_detail {
+
+template <class OutputIt> OutputIt put(OutputIt out, std::string_view text) {
+  return std::copy(text.begin(), text.end(), out);
+}
+
+// 带引号的名称
+template <class OutputIt> OutputIt quoted(OutputIt out, std::string_view name) {
+  *out++ = '"';
+  out = put(out, name);
+  *out++ = '"';
+  return out;
+}
+
+template <class OutputIt> OutputIt quotedBranch(OutputIt out, int branch) {
+  return quoted(out, branchNameText[branch]);
+}
+
+} // namespace chart_format_detail
+
+// 课盘各字段的 JSON 成员，不含外层花括号，供拼入其他对象。只写出 fields 所含部分，
+// 日干支、月将与占时总会写出；birth 为本命地支，给出时毕法格局计入本命
+template <class OutputIt>
+OutputIt formatChartFields(OutputIt out, const Chart &chart,
+                           ChartFieldMask fields = chartFieldsAll,
+                           std::optional<EarthlyBranch> birth = {}) {
+  using namespace chart_format_detail;
+  out = put(out, R"("dayPillar":")");
+  out = put(out, stemNameText[chart.dayStem]);
+  out = put(out, branchNameText[chart.dayBranch]);
+  out = put(out, R"(","moonGeneral":)");
+  out = quotedBranch(out, chart.moonGeneral);
+  out = put(out, R"(,"hourBranch":)");
+  out = quotedBranch(out, chart.hourBranch);
+  if (fields & ChartFieldNoble) {
+    out = put(out, chart.isDay() ? R"(,"daytime":true)" : R"(,"daytime":false)");
+  }
+  if (fields & ChartFieldPlate) {
+    out = put(out, R"(,"heavenPlate":[)");
+    for (int p = 0; p < 12; ++p) {
+      if (p) {
+        *out++ = ',';
+      }
+      out = quotedBranch(out, chart.heavenPlate[p]);
+    }
+    *out++ = ']';
+  }
+  if (fields & ChartFieldLessons) {
+    out = put(out, R"(,"lessons":[)");
+    for (int i = 0; i < 4; ++i) {
+      out = put(out, i ? ",[" : "[");
+      out = quoted(out, i == 0 ? stemNameText[chart.lower(0)] : branchNameText[chart.lower(i)]);
+      *out++ = ',';
+      out = quotedBranch(out, static_cast<int>(chart.upper(i)));
+      *out++ = ']';
+    }
+    *out++ = ']';
+  }
+  if (fields & ChartFieldTransmissions) {
+    out = put(out, R"(,"transmissions":[)");
+    for (int i = 0; i < 3; ++i) {
+      if (i) {
+        *out++ = ',';
+      }
+      out = quotedBranch(out, chart.transmissions[i]);
+    }
+    *out++ = ']';
+  }
+  if (fields & ChartFieldPatterns) {
+    out = put(out, R"(,"patterns":[)");
+    for (int i = 0; i < 2 && chart.patterns[i] != ChartPattern::None; ++i) {
+      if (i) {
+        *out++ = ',';
+      }
+      out = quoted(out, textOf(chart.patterns[i]));
+    }
+    *out++ = ']';
+  }
+  if (fields & ChartFieldNoble) {
+    out = put(out, R"(,"noble":)");
+    out = quotedBranch(out, chart.generals[0]);
+    out = put(out, (chart.flags & ChartClockwise) ? R"(,"clockwise":true)"
+                                                  : R"(,"clockwise":false)");
+  }
+  if (fields & ChartFieldGenerals) {
+    out = put(out, R"(,"generals":{)");
+    for (int g = 0; g < 12; ++g) {
+      if (g) {
+        *out++ = ',';
+      }
+      out = quoted(out, generalNameText[g]);
+      *out++ = ':';
+      out = quotedBranch(out, chart.generals[g]);
+    }
+    *out++ = '}';
+    ChartGenerals riders = annotateGenerals(chart);
+    auto formatRiders = [&](std::span<const General> generals,
+                            std::span<const GeneralRelation> relations) {
+      for (std::size_t i = 0; i < generals.size(); ++i) {
+        out = put(out, i ? ",[" : "[");
+        out = quoted(out, textOf(generals[i]));
+        *out++ = ',';
+        out = quoted(out, textOf(relations[i]));
+        *out++ = ']';
+      }
+      *out++ = ']';
+    };
+    if (fields & ChartFieldLessons) {
+      out = put(out, R"(,"lessonGenerals":[)");
+      formatRiders(riders.lessonRiders, riders.lessonRelations);
+    }
+    if (fields & ChartFieldTransmissions) {
+      out = put(out, R"(,"transmissionGenerals":[)");
+      formatRiders(riders.transmissionRiders, riders.transmissionRelations);
+    }
+  }
+  if (fields & ChartFieldLessonTypes) {
+    out = put(out, R"(,"lessonTypes":[)");
+    bool first = true;
+    for (LessonTypeSet types = classifyLessonTypes(chart); types; types &= types - 1) {
+      if (!first) {
+        *out++ = ',';
+      }
+      first = false;
+      out = quoted(out, lessonTypeNameText[std::countr_zero(types)]);
+    }
+    *out++ = ']';
+  }
+  if (fields & ChartFieldBiFa) {
+    out = put(out, R"(,"biFa":[)");
+    bool first = true;
+    forEachBiFa(birth ? classifyBiFa(chart, birth) : lookupBiFa(chart), [&](std::size_t id) {
+      if (!first) {
+        *out++ = ',';
+      }
+      first = false;
+      out = quoted(out, biFaNameText[id]);
+    });
+    *out++ = ']';
+  }
+  return out;
+}
+
+// 十二宫神煞的 JSON 成员 "shenSha"，不含前导逗号：以地支为键、神煞名数组为值，略去无神煞的宫
+template <class OutputIt> OutputIt formatShenSha(OutputIt out, const ShenShaPlate &plate) {
+  using namespace chart_format_detail;
+  out = put(out, R"("shenSha":{)");
+  bool first = true;
+  for (int b = 0; b < 12; ++b) {
+    if (plate[b] == 0) {
+      continue;
+    }
+    if (!first) {
+      *out++ = ',';
+    }
+    first = false;
+    out = quotedBranch(out, b);
+    *out++ = ':';
+    *out++ = '[';
+    bool firstSha = true;
+    forEachShenSha(plate[b], [&](ShenSha sha) {
+      if (!firstSha) {
+        *out++ = ',';
+      }
+      firstSha = false;
+      out = quoted(out, textOf(sha));
+    });
+    *out++ = ']';
+  }
+  *out++ = '}';
+  return out;
+}
+
+// 完整课盘的 JSON 对象。输出不超过 chartJsonMaxSize 字节，
+// 写入 fmt::basic_memory_buffer<char, chartJsonMaxSize> 时不分配堆内存
+template <class OutputIt> OutputIt formatChartJson(OutputIt out, const Chart &chart) {
+  *out++ = '{';
+  out = formatChartFields(out, chart);
+  *out++ = '}';
+  return out;
+}
+
+inline constexpr std::size_t chartJsonMaxSize = 2048;
+
+// 定长二进制记录：版本号 1 字节，其后依次为 Chart 各字段，末尾补 0 至 chartRecordSize
+inline constexpr uint8_t chartRecordVersion = 1;
+inline constexpr std::size_t chartRecordSize = 40;
+
+template <class OutputIt> OutputIt formatChartBinary(OutputIt out, const Chart &chart) {
+  *out++ = static_cast<char>(chartRecordVersion);
+  for (uint8_t value : {chart.dayStem, chart.dayBranch, chart.moonGeneral, chart.hourBranch}) {
+    *out++ = static_cast<char>(value);
+  }
+  out = std::copy(chart.heavenPlate.begin(), chart.heavenPlate.end(), out);
+  out = std::copy(chart.generals.begin(), chart.generals.end(), out);
+  out = std::copy(chart.lessons.begin(), chart.lessons.end(), out);
+  out = std::copy(chart.transmissions.begin(), chart.transmissions.end(), out);
+  for (ChartPattern p : chart.patterns) {
+    *out++ = static_cast<char>(p);
+  }
+  *out++ = static_cast<char>(chart.flags);
+  *out++ = 0;
+  return out;
+}
+
+// 读回二进制记录；版本不符或枚举值越界时为空
+std::optional<Chart> parseChartBinary(std::span<const uint8_t, chartRecordSize> record);
+
+// 人读的多行文本：四课、乘将、三传、格局与天地盘、天将
+template <class OutputIt> OutputIt formatChartText(OutputIt out, const Chart &chart) {
+  auto branch = [](int b) { return branchNameText[b]; };
+  out = fmt::format_to(out, "四课: ");
+  for (int i = 3; i >= 0; --i) {
+    std::string_view lower = i == 0 ? stemNameText[chart.lower(0)] : branch(chart.lower(i));
+    out = fmt::format_to(out, "{}/{}{}", branch(static_cast<int>(chart.upper(i))), lower,
+                         i ? " " : "\n");
+  }
+  ChartGenerals riders = annotateGenerals(chart);
+  out = fmt::format_to(out, "乘将: ");
+  for (int i = 3; i >= 0; --i) {
+    out = fmt::format_to(out, "{}（{}）{}", textOf(riders.lessonRiders[i]),
+                         textOf(riders.lessonRelations[i]), i ? " " : "\n");
+  }
+  constexpr std::string_view titles[] = {"初传", "中传", "末传"};
+  for (int i = 0; i < 3; ++i) {
+    out = fmt::format_to(out, "{}: {} {}（{}）\n", titles[i],
+                         branch(chart.transmissions[i]), textOf(riders.transmissionRiders[i]),
+                         textOf(riders.transmissionRelations[i]));
+  }
+  for (ChartPattern p : chart.patterns) {
+    if (p != ChartPattern::None) {
+      out = fmt::format_to(out, "格局: {}\n", textOf(p));
+    }
+  }
+  out = fmt::format_to(out, "天盘:");
+  for (int p = 0; p < 12; ++p) {
+    out = fmt::format_to(out, " {}", branch(chart.heavenPlate[p]));
+  }
+  out = fmt::format_to(out, "\n天将:");
+  for (int g = 0; g < 12; ++g) {
+    out = fmt::format_to(out, " {}{}", generalNameText[g], branch(chart.generals[g]));
+  }
+  *out++ = '\n';
+  return out;
+}
+
+// 一行请求
+struct ChartRequest {
+  std::size_t line; // 行号（或连接内的请求序号），从 1 起
+  ChartInput input;
+  bool valid;       // 是否解析成功
+};
+
+// 取行中前四个整数：年 月 日 时。分隔符可为空格、逗号、-、T、:、/，多余字段忽略。
+// 行尾可用 @生年 给出本命，取该年地支（生于立春前者应写上一年）
+bool parseChartInput(std::string_view line, ChartInput &input);
+
+// 解析逗号分隔的字段名列表：pillar、plate、lessons、transmissions、patterns、noble、generals、
+// types、bifa、shensha，或 all。有未知名称时返回 false
+bool parseChartFields(std::string_view list, ChartFieldMask &fields);
+
+// 追加一行 JSON 结果（含换行）；chart 为空时输出 error 字段。只写出 fields 所含部分，
+// fields 含 ChartFieldShenSha 且 shenSha 非空时另写出十二宫神煞
+void writeChartJson(fmt::memory_buffer &buffer, const ChartRequest &request,
+                    const std::optional<Chart> &chart, ChartFieldMask fields = chartFieldsAll,
+                    const ShenShaPlate *shenSha = nullptr);
+
+// CSV 表头，列与 writeChartCsv 一致
+inline constexpr std::string_view chartCsvHeader =
+    "line,date,hour,day_pillar,moon_general,hour_branch,daytime,lesson1,lesson2,lesson3,"
+    "lesson4,initial,middle,final,patterns,noble,clockwise,error\n";
+
+// 追加一条二进制记录；无法起课时为全 0 记录（版本号 0）。记录总是完整课盘，
+// fields 与 shenSha 仅为与其他行格式同型而设，调用方应按 chartFieldsInChart 起课
+void writeChartRecord(fmt::memory_buffer &buffer, const ChartRequest &request,
+                      const std::optional<Chart> &chart, ChartFieldMask fields = chartFieldsAll,
+                      const ShenShaPlate *shenSha = nullptr);
+
+// 追加一行 CSV 结果（含换行）；列固定，fields 不含的部分留空，神煞不在列中
+void writeChartCsv(fmt::memory_buffer &buffer, const ChartRequest &request,
+                   const std::optional<Chart> &chart, ChartFieldMask fields = chartFieldsAll,
+                   const ShenShaPlate *shenSha = nullptr);
+
+#endif // DA_LIU_REN_CHART_FORMAT_HPP
@@ -0,0 +1,123 @@
+//
+// 十二天将标注：天将与天盘地支的双向置换，四课上神、三传所乘天将（乘将）及将神五行生克。
+// 置换由贵人与顺逆直接写出，乘将与生克各为一次查表
+//
+
+#ifndef DA_LIU_REN_CHART_GENERALS_HPP
+#define DA_LIU_REN_CHART_GENERALS_HPP
+
+#include "chart.hpp"
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// 天将与所乘地支的五行关系，以天将为主
+enum class GeneralRelation : uint8_t {
+  Same,      // 比和
+  Generates, // 将生神
+  Generated, // 神生将
+  Overcomes, // 将克神：外战
+  Overcome,  // 神克将：内战
+};
+
+inline constexpr std::array<std::u8string_view, 5> generalRelationNames = {
+    u8"比和", u8"将生神", u8"神生将", u8"外战", u8"内战"};
+
+inline constexpr auto generalRelationNameText = makeNameText<generalRelationNames>();
+
+constexpr std::u8string_view nameOf(GeneralRelation relation) {
+  return generalRelationNames[static_cast<int>(relation)];
+}
+
+constexpr std::string_view textOf(GeneralRelation relation) {
+  return generalRelationNameText[static_cast<int>(relation)];
+}
+
+namespace chart_generals_detail {
+
+// 天将五行 general 与地支五行 branch 的关系
+constexpr GeneralRelation relation(int general, int branch) {
+  if (general == branch) {
+    return GeneralRelation::Same;
+  }
+  if (generate(general, branch)) {
+    return GeneralRelation::Generates;
+  }
+  if (generate(branch, general)) {
+    return GeneralRelation::Generated;
+  }
+  return overcome(general, branch) ? GeneralRelation::Overcomes : GeneralRelation::Overcome;
+}
+
+} // namespace chart_generals_detail
+
+// 天将乘地支的五行关系，下标为 [General][地支]
+inline constexpr auto generalRelationTable = [] {
+  std::array<std::array<GeneralRelation, 12>, 12> table{};
+  for (int g = 0; g < 12; ++g) {
+    for (int b = 0; b < 12; ++b) {
+      table[g][b] = chart_generals_detail::relation(generalFiveElements[g],
+                                                    earthlyBranchFiveElements[b]);
+    }
+  }
+  return table;
+}();
+
+constexpr GeneralRelation relationOf(General general, EarthlyBranch branch) {
+  return generalRelationTable[static_cast<int>(general)][static_cast<int>(branch)];
+}
+
+// 一课的天将标注。byGeneral 与 Chart::generals 相同，byBranch 为其逆置换
+struct ChartGenerals {
+  std::array<uint8_t, 12> byGeneral;                   // 天将（贵人起） -> 所乘天盘地支
+  std::array<General, 12> byBranch;                    // 天盘地支 -> 所乘天将
+  std::array<General, 4> lessonRiders;                 // 四课上神所乘天将
+  std::array<GeneralRelation, 4> lessonRelations;      // 四课乘将与上神的生克
+  std::array<General, 3> transmissionRiders;           // 三传所乘天将
+  std::array<GeneralRelation, 3> transmissionRelations; // 三传乘将与所乘地支的生克
+
+  constexpr EarthlyBranch branchOf(General general) const {
+    return static_cast<EarthlyBranch>(byGeneral[static_cast<int>(general)]);
+  }
+  constexpr General riderOf(EarthlyBranch branch) const {
+    return byBranch[static_cast<int>(branch)];
+  }
+};
+
+static_assert(sizeof(ChartGenerals) == 38);
+
+// 求一课的天将标注。课盘须含 ChartFieldGenerals；四课、三传的标注只在课盘含对应字段时有意义
+constexpr ChartGenerals annotateGenerals(const Chart &chart) {
+  ChartGenerals result{};
+  result.byGeneral = chart.generals;
+  for (int g = 0; g < 12; ++g) {
+    result.byBranch[chart.generals[g]] = static_cast<General>(g);
+  }
+  for (int i = 0; i < 4; ++i) {
+    EarthlyBranch upper = chart.upper(i);
+    result.lessonRiders[i] = result.riderOf(upper);
+    result.lessonRelations[i] = relationOf(result.lessonRiders[i], upper);
+  }
+  for (int i = 0; i < 3; ++i) {
+    auto branch = static_cast<EarthlyBranch>(chart.transmissions[i]);
+    result.transmissionRiders[i] = result.riderOf(branch);
+    result.transmissionRelations[i] = relationOf(result.transmissionRiders[i], branch);
+  }
+  return result;
+}
+
+static_assert(relationOf(General::TengShe, EarthlyBranch::Hai) == GeneralRelation::Overcome);
+static_assert(relationOf(General::BaiHu, EarthlyBranch::Yin) == GeneralRelation::Overcomes);
+static_assert([] {
+  Chart chart = computeChart(HeavenlyStem::Jia, EarthlyBranch::Zi, EarthlyBranch::Hai,
+                             EarthlyBranch::Wu);
+  ChartGenerals generals = annotateGenerals(chart);
+  for (int g = 0; g < 12; ++g) {
+    if (generals.riderOf(generals.branchOf(static_cast<General>(g))) != static_cast<General>(g)) {
+      return false;
+    }
+  }
+  return true;
+}());
+
+#endif // DA_LIU_REN_CHART_GENERALS_HPP
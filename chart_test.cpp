@@ -0,0 +1,499 @@
+//
+// 一致性校验：720 课表、成批排盘（AVX2 与标量）与 computeChart 逐课相同，农历成批换算与逐日换算相同，
+// 几条改过的取传规则得现行结果，区间外日期一律被拒，JSON、二进制记录与列式存档读回的课盘与原课盘相同。
+// 有不符时打印首例并返回非 0
+//
+
+#include "batch.hpp"
+#include "chart_archive.hpp"
+#include "chart_format.hpp"
+#include "course_table.hpp"
+#include "lesson_batch.hpp"
+#include "lunar.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+static_assert(std::has_unique_object_representations_v<Chart>);
+
+bool same(const Chart &a, const Chart &b) { return std::memcmp(&a, &b, sizeof(Chart)) == 0; }
+
+// 一项校验的结果：比较次数与不符次数，只记下首个不符的描述
+struct Result {
+  std::string_view name;
+  std::size_t checked = 0;
+  std::size_t failed = 0;
+  std::string first{};
+
+  void check(bool ok, auto &&describe) {
+    ++checked;
+    if (!ok && failed++ == 0) {
+      first = describe();
+    }
+  }
+};
+
+std::string describe(const Chart &chart) {
+  return fmt::format("{}{}日 {}将 {}时", stemNameText[chart.dayStem],
+                     branchNameText[chart.dayBranch], branchNameText[chart.moonGeneral],
+                     branchNameText[chart.hourBranch]);
+}
+
+// 全部 8640 课：60 日干支 × 12 月将 × 12 占时
+std::vector<Chart> allCharts() {
+  std::vector<Chart> charts;
+  charts.reserve(60 * 12 * 12);
+  for (int pillar = 0; pillar < 60; ++pillar) {
+    Pillar day = pillarOf(pillar);
+    for (int moon = 0; moon < 12; ++moon) {
+      for (int hour = 0; hour < 12; ++hour) {
+        charts.push_back(computeChart(day.stem, day.branch, static_cast<EarthlyBranch>(moon),
+                                      static_cast<EarthlyBranch>(hour)));
+      }
+    }
+  }
+  return charts;
+}
+
+Result checkCourseTable(const std::vector<Chart> &charts) {
+  Result result{"课表"};
+  for (const Chart &chart : charts) {
+    Chart looked = lookupChart(static_cast<HeavenlyStem>(chart.dayStem),
+                               static_cast<EarthlyBranch>(chart.dayBranch),
+                               static_cast<EarthlyBranch>(chart.moonGeneral),
+                               static_cast<EarthlyBranch>(chart.hourBranch));
+    result.check(same(looked, chart), [&] { return describe(chart); });
+  }
+  return result;
+}
+
+Result checkChartBatch(const std::vector<Chart> &charts) {
+  Result result{"成批排盘"};
+  std::size_t n = charts.size();
+  std::vector<uint8_t> stems(n), branches(n), moons(n), hours(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    stems[i] = charts[i].dayStem;
+    branches[i] = charts[i].dayBranch;
+    moons[i] = charts[i].moonGeneral;
+    hours[i] = charts[i].hourBranch;
+  }
+  LessonBatchInput input{stems, branches, moons, hours};
+
+  // 向量与标量两条路径的四课、贼克掩码与课表下标逐项相同
+  struct Buffers {
+    std::array<std::vector<uint8_t>, 4> lessons;
+    std::vector<uint8_t> thief, overcome;
+    std::vector<uint16_t> course;
+
+    explicit Buffers(std::size_t n) : thief(n), overcome(n), course(n) {
+      for (auto &lesson : lessons) {
+        lesson.resize(n);
+      }
+    }
+    LessonBatchOutput output() {
+      return {{lessons[0], lessons[1], lessons[2], lessons[3]}, thief, overcome, course};
+    }
+  };
+  Buffers dispatched(n), scalar(n);
+  computeLessonBatch(input, dispatched.output());
+  computeLessonBatchScalar(input, scalar.output());
+  for (std::size_t i = 0; i < n; ++i) {
+    bool ok = dispatched.thief[i] == scalar.thief[i] &&
+              dispatched.overcome[i] == scalar.overcome[i] &&
+              dispatched.course[i] == scalar.course[i];
+    for (int l = 0; l < 4; ++l) {
+      ok = ok && dispatched.lessons[l][i] == scalar.lessons[l][i] &&
+           dispatched.lessons[l][i] == charts[i].lessons[l];
+    }
+    result.check(ok, [&] { return describe(charts[i]) + " 四课"; });
+  }
+
+  std::vector<Chart> batch(n);
+  computeChartBatch(input, batch);
+  for (std::size_t i = 0; i < n; ++i) {
+    result.check(same(batch[i], charts[i]), [&] { return describe(charts[i]); });
+  }
+
+  // 非法值（干 ≥ 10、支 ≥ 12、日干支阴阳不同）放在向量块内与标量收尾处，两个接口都应抛出
+  for (std::size_t at : {std::size_t{5}, n - 1}) {
+    for (auto [stem, branch, moon, hour] : {std::tuple{10, 0, 0, 0}, std::tuple{0, 12, 0, 0},
+                                            std::tuple{0, 0, 200, 0}, std::tuple{0, 0, 0, 12},
+                                            std::tuple{0, 1, 0, 0}}) {
+      std::vector<uint8_t> bad[] = {stems, branches, moons, hours};
+      bad[0][at] = static_cast<uint8_t>(stem);
+      bad[1][at] = static_cast<uint8_t>(branch);
+      bad[2][at] = static_cast<uint8_t>(moon);
+      bad[3][at] = static_cast<uint8_t>(hour);
+      LessonBatchInput badInput{bad[0], bad[1], bad[2], bad[3]};
+      auto throws = [](auto &&call) {
+        try {
+          call();
+        } catch (const std::invalid_argument &) {
+          return true;
+        }
+        return false;
+      };
+      auto where = [&] {
+        return fmt::format("第 {} 项 干{} 支{} 将{} 时{}", at, stem, branch, moon, hour);
+      };
+      result.check(throws([&] { computeLessonBatch(badInput, dispatched.output()); }), where);
+      result.check(throws([&] { computeChartBatch(badInput, batch); }), where);
+    }
+  }
+  return result;
+}
+
+Result checkLunarBulk() {
+  using namespace std::chrono;
+  Result result{"农历成批换算"};
+  std::vector<int32_t> years;
+  std::vector<uint8_t> months, monthDays;
+  auto push = [&](int32_t y, int m, int d) {
+    years.push_back(y);
+    months.push_back(static_cast<uint8_t>(m));
+    monthDays.push_back(static_cast<uint8_t>(d));
+  };
+  for (sys_days d = sys_days(1900y / 1 / 31); d <= sys_days(2100y / 12 / 31); d += days{1}) {
+    year_month_day date(d);
+    push(static_cast<int>(date.year()), static_cast<int>(static_cast<unsigned>(date.month())),
+         static_cast<int>(static_cast<unsigned>(date.day())));
+  }
+  std::size_t inRange = years.size();
+  // 非法日期应全为 0 并计入返回值：区间两端之外各一日、日数在 32 位下回绕进区间的年份、
+  // 越出本月的日等。每例从 8 的倍数处连放 9 项，前 8 项落在向量通道，末项落在标量收尾
+  for (auto [y, m, d] : {std::tuple{1900, 1, 30}, std::tuple{2101, 1, 1},
+                         std::tuple{11761122, 5, 10}, std::tuple{2023, 2, 29},
+                         std::tuple{2023, 2, 30}, std::tuple{2100, 2, 29}, std::tuple{2024, 4, 31},
+                         std::tuple{2024, 5, 0}, std::tuple{2024, 13, 1}}) {
+    while (years.size() % 8 != 0) {
+      push(0, 0, 0);
+    }
+    for (int k = 0; k < 9; ++k) {
+      push(y, m, d);
+    }
+  }
+
+  std::vector<LunarDayInfo> bulk(years.size());
+  std::size_t outside = Lunar::solar2lunarBulk(years, months, monthDays, bulk);
+  result.check(outside == years.size() - inRange,
+               [&] { return fmt::format("超出区间 {} 项", outside); });
+
+  Lunar lunar;
+  for (std::size_t i = 0; i < years.size(); ++i) {
+    const LunarDayInfo &got = bulk[i];
+    auto where = [&] { return fmt::format("{}-{}-{}", years[i], months[i], monthDays[i]); };
+    if (i >= inRange) {
+      result.check(got.lunarMonth == 0, where);
+      continue;
+    }
+    const LunarDayInfo *info =
+        Lunar::dayInfo(Lunar::dayNumber(years[i], months[i], monthDays[i]));
+    std::optional<LunarDate> date = lunar.solar2lunarDate(years[i], months[i], monthDays[i]);
+    result.check(info != nullptr && date && got.lunarYear == info->lunarYear &&
+                     got.lunarMonth == info->lunarMonth && got.lunarDay == info->lunarDay &&
+                     got.isLeap == info->isLeap && got.ganzhiDay == info->ganzhiDay &&
+                     got.lunarYear + 1900 == date->lunarYear &&
+                     got.lunarMonth == date->lunarMonth && got.lunarDay == date->lunarDay &&
+                     static_cast<bool>(got.isLeap) == date->isLeap &&
+                     got.ganzhiDay == date->ganzhiDay,
+                 where);
+  }
+  return result;
+}
+
+// 课盘内核按古法改过的几条取传规则。before 为改动前 liu_ren.cpp 的结果（None 为该处抛出
+// “所有方法均无法确定三传”，三传无意义），after 为现行结果；二者相同的一条说明改写后结果未变
+struct RuleChange {
+  std::string_view rule;
+  HeavenlyStem stem;
+  EarthlyBranch branch, moon, hour;
+  ChartPattern before;
+  std::array<EarthlyBranch, 3> beforeTransmissions;
+  ChartPattern after;
+  std::array<EarthlyBranch, 3> afterTransmissions;
+};
+
+using enum EarthlyBranch;
+
+constexpr RuleChange ruleChanges[] = {
+    // 八专日原只认甲子、乙丑，现为日干寄宫即日支（甲寅、庚申、丁未、己未），且八专日不取遥克
+    {"八专日 刚日", HeavenlyStem::Jia, Yin, Chen, Zi,
+     ChartPattern::YaoKe, {Xu, Yin, Wu}, ChartPattern::BaZhuan, {Shen, Wu, Wu}},
+    // 柔日初传原取第四课上神之阴神退两位，现取第四课上神逆数三位
+    {"八专日 柔日", HeavenlyStem::Ding, Wei, Mao, Zi,
+     ChartPattern::None, {Zi, Zi, Zi}, ChartPattern::BaZhuan, {Hai, Xu, Xu}},
+    // 别责柔日初传原取第四课上神前三合，现取日支前三合
+    {"别责 柔日", HeavenlyStem::Xin, Wei, Mao, Zi,
+     ChartPattern::BieZe, {Si, Chou, Chou}, ChartPattern::BieZe, {Hai, Chou, Chou}},
+    // 昴星柔日初传原取酉上神，现取酉下神（天盘酉所临地盘）
+    {"昴星 柔日", HeavenlyStem::Ji, Si, Chou, Zi,
+     ChartPattern::DongSheYanMu, {Xu, Shen, Wu}, ChartPattern::DongSheYanMu, {Shen, Shen, Wu}},
+    // 返吟无克，驿马原自第四课上神起算，现自日支起算；返吟时第四课上神即日支，结果不变
+    {"返吟 无克", HeavenlyStem::Xin, Wei, Wu, Zi,
+     ChartPattern::WuQin, {Si, Chou, Chen}, ChartPattern::WuQin, {Si, Chou, Chen}},
+};
+
+Result checkRuleChanges() {
+  Result result{"取传规则变更"};
+  for (const RuleChange &change : ruleChanges) {
+    Chart chart = computeChart(change.stem, change.branch, change.moon, change.hour);
+    bool ok = chart.patterns[0] == change.after;
+    for (int i = 0; i < 3; ++i) {
+      ok = ok && chart.transmissions[i] == static_cast<uint8_t>(change.afterTransmissions[i]);
+    }
+    result.check(ok, [&] {
+      return fmt::format("{} {}：{}{}{}（改前 {}）", change.rule, describe(chart),
+                         branchNameText[chart.transmissions[0]],
+                         branchNameText[chart.transmissions[1]],
+                         branchNameText[chart.transmissions[2]], textOf(change.before));
+    });
+  }
+  return result;
+}
+
+// 区间外的年份，包括闭式日数计算在 32 位下会回绕进区间的年份，chartAt 与 dayInfo 都应拒绝
+Result checkOutOfRange() {
+  Result result{"越界日期"};
+  for (int32_t year : {1899, 2101, 11761122, std::numeric_limits<int32_t>::max(),
+                       std::numeric_limits<int32_t>::min()}) {
+    auto where = [&] { return fmt::format("{}-5-10", year); };
+    result.check(!chartAt({year, 5, 10, 12}), where);
+    result.check(Lunar::dayInfo(Lunar::dayNumber(year, 5, 10)) == nullptr, where);
+  }
+  return result;
+}
+
+// 只够读回 formatChartJson 输出的 JSON 子集：对象、数组、不含转义的字符串与 true/false
+struct Json {
+  bool boolean = false;
+  std::string text;
+  std::vector<Json> items;
+  std::vector<std::pair<std::string, Json>> members;
+
+  const Json &operator[](std::string_view key) const {
+    for (const auto &[name, value] : members) {
+      if (name == key) {
+        return value;
+      }
+    }
+    throw std::runtime_error(fmt::format("缺少成员 {}", key));
+  }
+};
+
+class JsonReader {
+public:
+  explicit JsonReader(std::string_view text) : text(text) {}
+
+  Json read() {
+    Json value = parse();
+    if (pos != text.size()) {
+      fail();
+    }
+    return value;
+  }
+
+private:
+  [[noreturn]] void fail() const {
+    throw std::runtime_error(fmt::format("第 {} 字节处 JSON 格式错误", pos));
+  }
+
+  void expect(char c) {
+    if (pos >= text.size() || text[pos] != c) {
+      fail();
+    }
+    ++pos;
+  }
+
+  bool take(std::string_view word) {
+    if (text.substr(pos).starts_with(word)) {
+      pos += word.size();
+      return true;
+    }
+    return false;
+  }
+
+  std::string string() {
+    expect('"');
+    std::size_t end = text.find('"', pos);
+    if (end == std::string_view::npos) {
+      fail();
+    }
+    std::string value(text.substr(pos, end - pos));
+    pos = end + 1;
+    return value;
+  }
+
+  Json parse() {
+    Json value;
+    if (take("true")) {
+      value.boolean = true;
+    } else if (take("false")) {
+      value.boolean = false;
+    } else if (pos < text.size() && text[pos] == '"') {
+      value.text = string();
+    } else if (take("[")) {
+      while (!take("]")) {
+        if (!value.items.empty()) {
+          expect(',');
+        }
+        value.items.push_back(parse());
+      }
+    } else if (take("{")) {
+      while (!take("}")) {
+        if (!value.members.empty()) {
+          expect(',');
+        }
+        std::string name = string();
+        expect(':');
+        value.members.emplace_back(std::move(name), parse());
+      }
+    } else {
+      fail();
+    }
+    return value;
+  }
+
+  std::string_view text;
+  std::size_t pos = 0;
+};
+
+// 名称在表中的下标，找不到时抛出
+template <class Table> uint8_t indexOf(const Table &table, std::string_view name) {
+  for (std::size_t i = 0; i < table.size(); ++i) {
+    if (table[i] == name) {
+      return static_cast<uint8_t>(i);
+    }
+  }
+  throw std::runtime_error(fmt::format("未知名称 {}", name));
+}
+
+// 由 formatChartJson 的输出还原课盘
+Chart chartFromJson(const Json &json) {
+  auto branch = [](const Json &value) { return indexOf(branchNameText, value.text); };
+  Chart chart{};
+  std::string_view pillar = json["dayPillar"].text;
+  std::size_t stemBytes = stemNameText[0].size();
+  chart.dayStem = indexOf(stemNameText, pillar.substr(0, stemBytes));
+  chart.dayBranch = indexOf(branchNameText, pillar.substr(stemBytes));
+  chart.moonGeneral = branch(json["moonGeneral"]);
+  chart.hourBranch = branch(json["hourBranch"]);
+  for (int p = 0; p < 12; ++p) {
+    chart.heavenPlate[p] = branch(json["heavenPlate"].items.at(p));
+  }
+  for (int i = 0; i < 4; ++i) {
+    const Json &lesson = json["lessons"].items.at(i);
+    uint8_t lower = i == 0 ? indexOf(stemNameText, lesson.items.at(0).text)
+                           : branch(lesson.items.at(0));
+    chart.lessons[i] = static_cast<uint8_t>(lower << 4 | branch(lesson.items.at(1)));
+  }
+  for (int i = 0; i < 3; ++i) {
+    chart.transmissions[i] = branch(json["transmissions"].items.at(i));
+  }
+  const std::vector<Json> &patterns = json["patterns"].items;
+  for (std::size_t i = 0; i < patterns.size() && i < 2; ++i) {
+    chart.patterns[i] = static_cast<ChartPattern>(indexOf(chartPatternNameText, patterns[i].text));
+  }
+  const Json &generals = json["generals"];
+  for (int g = 0; g < 12; ++g) {
+    chart.generals[g] = branch(generals[generalNameText[g]]);
+  }
+  if (branch(json["noble"]) != chart.generals[0]) {
+    throw std::runtime_error("noble 与 generals 不符");
+  }
+  chart.flags = static_cast<uint8_t>((json["daytime"].boolean ? ChartDaytime : 0) |
+                                     (json["clockwise"].boolean ? ChartClockwise : 0));
+  return chart;
+}
+
+Result checkJson(const std::vector<Chart> &charts) {
+  Result result{"JSON 往返"};
+  for (const Chart &chart : charts) {
+    fmt::basic_memory_buffer<char, chartJsonMaxSize> buffer;
+    formatChartJson(std::back_inserter(buffer), chart);
+    std::string_view text(buffer.data(), buffer.size());
+    std::string error;
+    bool ok = text.size() <= chartJsonMaxSize;
+    try {
+      ok = ok && same(chartFromJson(JsonReader(text).read()), chart);
+    } catch (const std::exception &e) {
+      ok = false;
+      error = e.what();
+    }
+    result.check(ok, [&] { return describe(chart) + (error.empty() ? "" : "：" + error); });
+  }
+  return result;
+}
+
+Result checkBinary(const std::vector<Chart> &charts) {
+  Result result{"二进制记录往返"};
+  for (const Chart &chart : charts) {
+    std::array<uint8_t, chartRecordSize> record{};
+    uint8_t *end = formatChartBinary(record.data(), chart);
+    std::optional<Chart> parsed = parseChartBinary(record);
+    result.check(end == record.data() + record.size() && parsed && same(*parsed, chart),
+                 [&] { return describe(chart); });
+  }
+  // 全 0 记录（无法起课）的版本号为 0，读回为空
+  result.check(!parseChartBinary(std::array<uint8_t, chartRecordSize>{}),
+               [] { return std::string("全 0 记录"); });
+  return result;
+}
+
+Result checkArchive(const std::vector<Chart> &charts) {
+  Result result{"存档往返"};
+  std::filesystem::path path = std::filesystem::temp_directory_path() / "da_liu_ren_chart_test.dlr";
+  try {
+    {
+      // 行组取得小，使存档含多个行组与一个不满的末组
+      ChartArchiveWriter writer(path.string(), 1000);
+      writer.append(charts);
+      writer.close();
+    }
+    ChartArchive archive(path.string());
+    result.check(archive.size() == charts.size(),
+                 [&] { return fmt::format("行数 {}", archive.size()); });
+    for (std::size_t i = 0; i < charts.size() && i < archive.size(); ++i) {
+      result.check(same(archive.chart(i), charts[i]), [&] { return describe(charts[i]); });
+    }
+  } catch (const std::exception &e) {
+    result.check(false, [&] { return std::string(e.what()); });
+  }
+  std::error_code ignored;
+  std::filesystem::remove(path, ignored);
+  return result;
+}
+
+} // namespace
+
+int main() {
+  std::vector<Chart> charts = allCharts();
+  Result results[] = {checkCourseTable(charts), checkChartBatch(charts), checkLunarBulk(),
+                      checkRuleChanges(),       checkOutOfRange(),       checkJson(charts),
+                      checkBinary(charts),      checkArchive(charts)};
+  int status = 0;
+  for (const Result &r : results) {
+    if (r.failed == 0) {
+      fmt::print("{}：{} 项全部相符\n", r.name, r.checked);
+    } else {
+      fmt::print(stderr, "{}：{} 项中 {} 项不符，首例 {}\n", r.name, r.checked, r.failed, r.first);
+      status = 1;
+    }
+  }
+  return status;
+}
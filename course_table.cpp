@@ -0,0 +1,3 @@
+#include "course_table.hpp"
+
+constexpr std::array<CourseEntry, courseCount> courseTable = generateCourseTable();
@@ -0,0 +1,57 @@
+//
+// 720 课表：按（日干支, 天盘旋转, 昼夜）预排的全部课盘，编译期生成
+//
+
+#ifndef DA_LIU_REN_COURSE_TABLE_HPP
+#define DA_LIU_REN_COURSE_TABLE_HPP
+
+#include "chart.hpp"
+#include "pillar.hpp"
+#include <array>
+
+// 课表项，每项独占一条缓存行，查表只触及一行
+struct alignas(64) CourseEntry {
+  Chart chart;
+};
+
+// 60 日干支 × 12 旋转 × 昼夜
+inline constexpr int courseCount = 60 * 12 * 2;
+
+// 课表下标，rotation 为月将减占时（0~11）
+constexpr int courseIndex(int dayPillar, int rotation, bool isDay) {
+  return (dayPillar * 12 + rotation) * 2 + (isDay ? 1 : 0);
+}
+
+// 生成课表，各项月将、占时取该旋转与昼夜下的代表值
+constexpr std::array<CourseEntry, courseCount> generateCourseTable() {
+  std::array<CourseEntry, courseCount> table{};
+  for (int pillar = 0; pillar < 60; ++pillar) {
+    Pillar day = pillarOf(pillar);
+    for (int rotation = 0; rotation < 12; ++rotation) {
+      for (int isDay = 0; isDay < 2; ++isDay) {
+        int hour = isDay ? 3 : 0; // 卯时为昼，子时为夜
+        table[courseIndex(pillar, rotation, isDay)].chart = computeChart(
+            day.stem, day.branch, static_cast<EarthlyBranch>(hour + rotation),
+            static_cast<EarthlyBranch>(hour));
+      }
+    }
+  }
+  return table;
+}
+
+// 课表本体，定义于 course_table.cpp
+extern const std::array<CourseEntry, courseCount> courseTable;
+
+// 查表排盘，结果与 computeChart 相同
+inline Chart lookupChart(HeavenlyStem dayStem, EarthlyBranch dayBranch,
+                         EarthlyBranch moonGeneral, EarthlyBranch hourBranch) {
+  int rotation = moonGeneral - hourBranch;
+  Chart chart = courseTable[courseIndex(pillarIndex({dayStem, dayBranch}), rotation,
+                                        isDaytime(hourBranch))]
+                    .chart;
+  chart.moonGeneral = static_cast<uint8_t>(moonGeneral);
+  chart.hourBranch = static_cast<uint8_t>(hourBranch);
+  return chart;
+}
+
+#endif // DA_LIU_REN_COURSE_TABLE_HPP
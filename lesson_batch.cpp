@@ -0,0 +1,270 @@
+#include "lesson_batch.hpp"
+#include "course_table.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DA_LIU_REN_HAS_AVX2_KERNEL 1
+#define DA_LIU_REN_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using namespace chart_detail;
+
+// 五行所克：下标为五行（1~5），0 位不用
+constexpr std::array<uint8_t, 16> overcomeTarget = {0, 3, 4, 5, 1, 2};
+
+// 输入各数组等长，且各项为合法枚举：日干 0~9，日支、月将、占时 0~11，日干支阴阳相同。
+// 越界的值会使宫位表、课表的下标越界，一律抛出
+void checkInput(const LessonBatchInput &input, std::string_view caller) {
+  std::size_t n = input.dayStem.size();
+  if (input.dayBranch.size() != n || input.moonGeneral.size() != n ||
+      input.hourBranch.size() != n) {
+    throw std::invalid_argument(std::string(caller) + ": 输入数组长度不一致");
+  }
+  bool valid = true;
+  for (std::size_t i = 0; i < n; ++i) {
+    uint8_t stem = input.dayStem[i], branch = input.dayBranch[i];
+    valid &= (stem < 10) & (branch < 12) & (input.moonGeneral[i] < 12) &
+             (input.hourBranch[i] < 12) & (((stem ^ branch) & 1) == 0);
+  }
+  if (!valid) {
+    throw std::invalid_argument(std::string(caller) + ": 输入含非法的干支或地支值");
+  }
+}
+
+void checkSizes(const LessonBatchInput &input, const LessonBatchOutput &output) {
+  checkInput(input, "computeLessonBatch");
+  std::size_t n = input.dayStem.size();
+  for (const auto &lesson : output.lessons) {
+    if (lesson.size() < n) {
+      throw std::invalid_argument("computeLessonBatch: 输出数组过短");
+    }
+  }
+  if (output.thiefMask.size() < n || output.overcomeMask.size() < n || output.course.size() < n) {
+    throw std::invalid_argument("computeLessonBatch: 输出数组过短");
+  }
+}
+
+uint16_t courseOf(int stem, int branch, int rotation, int hour) {
+  return static_cast<uint16_t>(
+      courseIndex(pillarIndex({static_cast<HeavenlyStem>(stem), static_cast<EarthlyBranch>(branch)}),
+                  rotation, isDaytime(static_cast<EarthlyBranch>(hour))));
+}
+
+// 处理 [begin, end) 的标量循环，AVX2 实现也用它收尾
+void lessonRange(const LessonBatchInput &in, const LessonBatchOutput &out, std::size_t begin,
+                 std::size_t end) {
+  for (std::size_t i = begin; i < end; ++i) {
+    int stem = in.dayStem[i], branch = in.dayBranch[i], hour = in.hourBranch[i];
+    int rotation = wrap(in.moonGeneral[i] - hour);
+    int palace = stemPalace(stem);
+    int lower[4] = {stem, wrap(palace + rotation), branch, wrap(branch + rotation)};
+    int upper[4] = {lower[1], wrap(lower[1] + rotation), lower[3], wrap(lower[3] + rotation)};
+    int lowerElement[4] = {stemElement(stem), branchElement(lower[1]), branchElement(branch),
+                           branchElement(lower[3])};
+    uint8_t thief = 0, overcome = 0;
+    for (int k = 0; k < 4; ++k) {
+      out.lessons[k][i] = static_cast<uint8_t>(lower[k] << 4 | upper[k]);
+      thief |= static_cast<uint8_t>(overcomes(lowerElement[k], branchElement(upper[k])) << k);
+      overcome |= static_cast<uint8_t>(overcomes(branchElement(upper[k]), lowerElement[k]) << k);
+    }
+    out.thiefMask[i] = thief;
+    out.overcomeMask[i] = overcome;
+    out.course[i] = courseOf(stem, branch, rotation, hour);
+  }
+}
+
+// 只求课表下标的标量循环
+void courseRange(const LessonBatchInput &in, std::span<uint16_t> course, std::size_t begin,
+                 std::size_t end) {
+  for (std::size_t i = begin; i < end; ++i) {
+    int hour = in.hourBranch[i];
+    course[i] = courseOf(in.dayStem[i], in.dayBranch[i], wrap(in.moonGeneral[i] - hour), hour);
+  }
+}
+
+#ifdef DA_LIU_REN_HAS_AVX2_KERNEL
+
+// 16 项查找表，两个 128 位通道各放一份，供 pshufb 使用
+template <std::size_t N>
+DA_LIU_REN_AVX2 __m256i lookupTable(const std::array<uint8_t, N> &values) {
+  alignas(16) uint8_t table[16] = {};
+  std::copy(values.begin(), values.end(), table);
+  return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(table)));
+}
+
+template <class T, std::size_t N>
+constexpr std::array<uint8_t, N> bytes(const std::array<T, N> &values) {
+  std::array<uint8_t, N> result{};
+  for (std::size_t i = 0; i < N; ++i) {
+    result[i] = static_cast<uint8_t>(values[i]);
+  }
+  return result;
+}
+
+// 各字节取模 12，输入须小于 24
+DA_LIU_REN_AVX2 inline __m256i mod12(__m256i v) {
+  return _mm256_min_epu8(v, _mm256_sub_epi8(v, _mm256_set1_epi8(12)));
+}
+
+DA_LIU_REN_AVX2 inline __m256i load(std::span<const uint8_t> s, std::size_t i) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s.data() + i));
+}
+
+DA_LIU_REN_AVX2 inline void store(std::span<uint8_t> s, std::size_t i, __m256i v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(s.data() + i), v);
+}
+
+// 打包一课：下神移至高 4 位
+DA_LIU_REN_AVX2 inline __m256i pack(__m256i lower, __m256i upper) {
+  return _mm256_or_si256(_mm256_andnot_si256(_mm256_set1_epi8(0x0f), _mm256_slli_epi16(lower, 4)),
+                         upper);
+}
+
+// 贼克位：x 所克之五行等于 y 时置第 k 位
+DA_LIU_REN_AVX2 inline __m256i overcomeBit(__m256i targets, __m256i x, __m256i y, int k) {
+  __m256i hit = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(targets, x), y);
+  return _mm256_and_si256(hit, _mm256_set1_epi8(static_cast<char>(1 << k)));
+}
+
+// 课表下标 = 干支序号 * 24 + 旋转 * 2 + 昼夜，写入 course[i, i + 32)
+DA_LIU_REN_AVX2 inline void storeCourse(std::span<uint16_t> course, std::size_t i, __m256i stem,
+                                        __m256i branch, __m256i hour, __m256i rotation) {
+  __m256i stem2 = _mm256_add_epi8(stem, stem);
+  __m256i stem6 = _mm256_add_epi8(_mm256_add_epi8(stem2, stem2), stem2);
+  __m256i branch2 = _mm256_add_epi8(branch, branch);
+  __m256i branch5 = _mm256_add_epi8(_mm256_add_epi8(branch2, branch2), branch);
+  __m256i pillar = _mm256_sub_epi8(_mm256_add_epi8(stem6, _mm256_set1_epi8(60)), branch5);
+  pillar = _mm256_min_epu8(pillar, _mm256_sub_epi8(pillar, _mm256_set1_epi8(60)));
+  __m256i fromMao = _mm256_sub_epi8(hour, _mm256_set1_epi8(3));
+  __m256i isDay = _mm256_cmpeq_epi8(_mm256_min_epu8(fromMao, _mm256_set1_epi8(5)), fromMao);
+  __m256i low = _mm256_add_epi8(_mm256_add_epi8(rotation, rotation),
+                                _mm256_and_si256(isDay, _mm256_set1_epi8(1)));
+  for (int half = 0; half < 2; ++half) {
+    __m128i p = half ? _mm256_extracti128_si256(pillar, 1) : _mm256_castsi256_si128(pillar);
+    __m128i l = half ? _mm256_extracti128_si256(low, 1) : _mm256_castsi256_si128(low);
+    __m256i index = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(p),
+                                                        _mm256_set1_epi16(24)),
+                                     _mm256_cvtepu8_epi16(l));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(course.data() + i + half * 16), index);
+  }
+}
+
+// 旋转 = 月将 - 占时（模 12）
+DA_LIU_REN_AVX2 inline __m256i rotationOf(__m256i moon, __m256i hour) {
+  return mod12(_mm256_sub_epi8(_mm256_add_epi8(moon, _mm256_set1_epi8(12)), hour));
+}
+
+DA_LIU_REN_AVX2 void lessonRangeAvx2(const LessonBatchInput &in, const LessonBatchOutput &out,
+                                     std::size_t size) {
+  const __m256i palaceTable = lookupTable(bytes(::palaceTable));
+  const __m256i stemElements = lookupTable(bytes(heavenlyStemFiveElements));
+  const __m256i branchElements = lookupTable(bytes(earthlyBranchFiveElements));
+  const __m256i targets = lookupTable(overcomeTarget);
+  std::size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i stem = load(in.dayStem, i), branch = load(in.dayBranch, i);
+    __m256i hour = load(in.hourBranch, i);
+    __m256i rotation = rotationOf(load(in.moonGeneral, i), hour);
+    // 四课：干上、干上之上、支上、支上之上
+    __m256i u0 = mod12(_mm256_add_epi8(_mm256_shuffle_epi8(palaceTable, stem), rotation));
+    __m256i u1 = mod12(_mm256_add_epi8(u0, rotation));
+    __m256i u2 = mod12(_mm256_add_epi8(branch, rotation));
+    __m256i u3 = mod12(_mm256_add_epi8(u2, rotation));
+    store(out.lessons[0], i, pack(stem, u0));
+    store(out.lessons[1], i, pack(u0, u1));
+    store(out.lessons[2], i, pack(branch, u2));
+    store(out.lessons[3], i, pack(u2, u3));
+
+    __m256i e0 = _mm256_shuffle_epi8(branchElements, u0);
+    __m256i e1 = _mm256_shuffle_epi8(branchElements, u1);
+    __m256i e2 = _mm256_shuffle_epi8(branchElements, u2);
+    __m256i e3 = _mm256_shuffle_epi8(branchElements, u3);
+    __m256i stemElement = _mm256_shuffle_epi8(stemElements, stem);
+    __m256i branchElement = _mm256_shuffle_epi8(branchElements, branch);
+    __m256i thief = _mm256_or_si256(
+        _mm256_or_si256(overcomeBit(targets, stemElement, e0, 0), overcomeBit(targets, e0, e1, 1)),
+        _mm256_or_si256(overcomeBit(targets, branchElement, e2, 2), overcomeBit(targets, e2, e3, 3)));
+    __m256i overcome = _mm256_or_si256(
+        _mm256_or_si256(overcomeBit(targets, e0, stemElement, 0), overcomeBit(targets, e1, e0, 1)),
+        _mm256_or_si256(overcomeBit(targets, e2, branchElement, 2), overcomeBit(targets, e3, e2, 3)));
+    store(out.thiefMask, i, thief);
+    store(out.overcomeMask, i, overcome);
+
+    storeCourse(out.course, i, stem, branch, hour, rotation);
+  }
+  lessonRange(in, out, i, size);
+}
+
+DA_LIU_REN_AVX2 void courseRangeAvx2(const LessonBatchInput &in, std::span<uint16_t> course,
+                                     std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i hour = load(in.hourBranch, i);
+    storeCourse(course, i, load(in.dayStem, i), load(in.dayBranch, i), hour,
+                rotationOf(load(in.moonGeneral, i), hour));
+  }
+  courseRange(in, course, i, size);
+}
+
+bool hasAvx2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+#endif // DA_LIU_REN_HAS_AVX2_KERNEL
+
+} // namespace
+
+void computeLessonBatchScalar(const LessonBatchInput &input, const LessonBatchOutput &output) {
+  checkSizes(input, output);
+  lessonRange(input, output, 0, input.dayStem.size());
+}
+
+void computeLessonBatch(const LessonBatchInput &input, const LessonBatchOutput &output) {
+  checkSizes(input, output);
+#ifdef DA_LIU_REN_HAS_AVX2_KERNEL
+  if (hasAvx2()) {
+    lessonRangeAvx2(input, output, input.dayStem.size());
+    return;
+  }
+#endif
+  lessonRange(input, output, 0, input.dayStem.size());
+}
+
+void computeChartBatch(const LessonBatchInput &input, std::span<Chart> output) {
+  checkInput(input, "computeChartBatch");
+  std::size_t n = input.dayStem.size();
+  if (output.size() < n) {
+    throw std::invalid_argument("computeChartBatch: 输出数组过短");
+  }
+  // 按块处理，课表下标留在栈上；四课与贼克掩码已在课表里，不必再算
+  constexpr std::size_t block = 256;
+  std::array<uint16_t, block> course;
+  for (std::size_t begin = 0; begin < n; begin += block) {
+    std::size_t count = std::min(block, n - begin);
+    LessonBatchInput part{input.dayStem.subspan(begin, count), input.dayBranch.subspan(begin, count),
+                          input.moonGeneral.subspan(begin, count),
+                          input.hourBranch.subspan(begin, count)};
+#ifdef DA_LIU_REN_HAS_AVX2_KERNEL
+    if (hasAvx2()) {
+      courseRangeAvx2(part, course, count);
+    } else {
+      courseRange(part, course, 0, count);
+    }
+#else
+    courseRange(part, course, 0, count);
+#endif
+    for (std::size_t k = 0; k < count; ++k) {
+      Chart &chart = output[begin + k];
+      chart = courseTable[course[k]].chart;
+      chart.moonGeneral = part.moonGeneral[k];
+      chart.hourBranch = part.hourBranch[k];
+    }
+  }
+}
@@ -0,0 +1,39 @@
+//
+// 成批立四课：结构数组（SoA）输入，x86 上以 AVX2 一次处理 32 课，其余平台走标量
+//
+
+#ifndef DA_LIU_REN_LESSON_BATCH_HPP
+#define DA_LIU_REN_LESSON_BATCH_HPP
+
+#include "chart.hpp"
+#include <array>
+#include <cstdint>
+#include <span>
+
+// 成批起课的输入，各数组等长，元素为枚举值：日干 0~9，日支、月将、占时 0~11，日干支阴阳相同
+struct LessonBatchInput {
+  std::span<const uint8_t> dayStem;
+  std::span<const uint8_t> dayBranch;
+  std::span<const uint8_t> moonGeneral;
+  std::span<const uint8_t> hourBranch;
+};
+
+// 成批起课的输出，各数组不短于输入
+struct LessonBatchOutput {
+  std::array<std::span<uint8_t>, 4> lessons; // 同 Chart::lessons，高 4 位为下，低 4 位为上神
+  std::span<uint8_t> thiefMask;              // 第 i 位为第 i 课下贼上
+  std::span<uint8_t> overcomeMask;           // 第 i 位为第 i 课上克下
+  std::span<uint16_t> course;                // 720 课表下标，参见 courseIndex
+};
+
+// 立四课并求贼克掩码与课表下标；运行时检测 CPU，支持 AVX2 时走向量实现。
+// 输入数组不等长、输出过短或输入值非法时抛出 std::invalid_argument
+void computeLessonBatch(const LessonBatchInput &input, const LessonBatchOutput &output);
+
+// 标量实现，供无 AVX2 的平台与校验使用
+void computeLessonBatchScalar(const LessonBatchInput &input, const LessonBatchOutput &output);
+
+// 成批排盘：先成批求课表下标，再按下标从 720 课表取课盘；校验同 computeLessonBatch
+void computeChartBatch(const LessonBatchInput &input, std::span<Chart> output);
+
+#endif // DA_LIU_REN_LESSON_BATCH_HPP
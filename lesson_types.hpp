@@ -0,0 +1,599 @@
+//
+// 课体分类：把 doc/64课.md 中能由课盘本身判定的课体条件编译为位掩码谓词，
+// 一趟求出课盘的特征位，再逐条规则以与、异或比较，得到命中课体的 64 位集合
+//
+
+#ifndef DA_LIU_REN_LESSON_TYPES_HPP
+#define DA_LIU_REN_LESSON_TYPES_HPP
+
+#include "chart.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+
+// 课体编号。取传九法与伏吟、返吟诸格之外，收录只依赖日干支、天地盘、四课、三传与天将的课体；
+// 需太岁、月建、行年本命、旺相休囚或节气的课体（三光、三阳、时泰、天祸、魄化等）不在此列
+enum class LessonType : uint8_t {
+  YuanShou,     // 元首课
+  ChongShen,    // 重审课
+  ZhiYi,        // 知一课
+  SheHai,       // 涉害课
+  JianJi,       // 见机格
+  ChaWei,       // 察微格
+  ZhuiXia,      // 缀瑕格
+  YaoKe,        // 遥克课
+  HaoShi,       // 蒿矢课
+  DanShe,       // 弹射课
+  MaoXing,      // 昴星课
+  HuShi,        // 虎视格
+  DongSheYanMu, // 冬蛇掩目格
+  BieZe,        // 别责课
+  BaZhuan,      // 八专课
+  FuYin,        // 伏吟课
+  ZiRen,        // 自任格
+  ZiXin,        // 自信格
+  DuChuan,      // 杜传格
+  FanYin,       // 反吟课
+  WuYi,         // 无依格：反吟有克
+  WuQin,        // 无亲格：反吟无克
+  SanQi,        // 三奇课
+  LiuYi,        // 六仪课
+  ZhuYin,       // 铸印课
+  XuanGai,      // 轩盖课
+  ZhuoLun,      // 斫轮课
+  YinCong,      // 引从课
+  HengTong,     // 亨通课
+  JuSheng,      // 俱生格
+  HuSheng,      // 互生格
+  ZhanGuan,     // 斩关课
+  BiKou,        // 闭口课
+  YouZi,        // 游子课
+  SanJiao,      // 三交课
+  LuanShou,     // 乱首课
+  ZhuiXu,       // 赘婿课
+  ChongPo,      // 冲破课
+  YinYi,        // 淫佚课
+  WuYin,        // 无淫课
+  DuE,          // 度厄课
+  WuLu,         // 无禄课
+  JueSi,        // 绝嗣课
+  QinHai,       // 侵害课
+  XingShang,    // 刑伤课
+  TianWang,     // 天网课
+  LongZhan,     // 龙战课
+  SiQi,         // 死奇课
+  YangJiu,      // 殃咎课
+  JiuChou,      // 九丑课
+  GuiMu,        // 鬼墓课
+  QuanJu,       // 全局课
+  RunXia,       // 润下格
+  YanShang,     // 炎上格
+  QuZhi,        // 曲直格
+  CongGe,       // 从革格
+  JiaSe,        // 稼穑格
+  XuanTai,      // 玄胎课
+  BingTai,      // 病胎格
+  ShengTai,     // 生胎格
+  ShunJianChuan, // 连珠课顺间传
+  NiJianChuan,  // 连珠课逆间传
+  LiuYang,      // 六纯课六阳
+  LiuYin,       // 六纯课六阴
+};
+
+// 课体名称，下标为 LessonType
+inline constexpr std::array<std::u8string_view, 64> lessonTypeNames = {
+    u8"元首课", u8"重审课", u8"知一课", u8"涉害课", u8"见机格", u8"察微格",
+    u8"缀瑕格", u8"遥克课", u8"蒿矢课", u8"弹射课", u8"昴星课", u8"虎视格",
+    u8"冬蛇掩目格", u8"别责课", u8"八专课", u8"伏吟课", u8"自任格", u8"自信格",
+    u8"杜传格", u8"反吟课", u8"无依格", u8"无亲格", u8"三奇课", u8"六仪课",
+    u8"铸印课", u8"轩盖课", u8"斫轮课", u8"引从课", u8"亨通课", u8"俱生格",
+    u8"互生格", u8"斩关课", u8"闭口课", u8"游子课", u8"三交课", u8"乱首课",
+    u8"赘婿课", u8"冲破课", u8"淫佚课", u8"无淫课", u8"度厄课", u8"无禄课",
+    u8"绝嗣课", u8"侵害课", u8"刑伤课", u8"天网课", u8"龙战课", u8"死奇课",
+    u8"殃咎课", u8"九丑课", u8"鬼墓课", u8"全局课", u8"润下格", u8"炎上格",
+    u8"曲直格", u8"从革格", u8"稼穑格", u8"玄胎课", u8"病胎格", u8"生胎格",
+    u8"顺间传", u8"逆间传", u8"六阳课", u8"六阴课"};
+
+inline constexpr auto lessonTypeNameText = makeNameText<lessonTypeNames>();
+
+constexpr std::u8string_view nameOf(LessonType type) {
+  return lessonTypeNames[static_cast<int>(type)];
+}
+
+constexpr std::string_view textOf(LessonType type) {
+  return lessonTypeNameText[static_cast<int>(type)];
+}
+
+// 命中课体的集合，第 i 位为 LessonType i
+using LessonTypeSet = uint64_t;
+
+constexpr bool contains(LessonTypeSet set, LessonType type) {
+  return set >> static_cast<int>(type) & 1;
+}
+
+namespace lesson_type_detail {
+
+using namespace chart_detail;
+
+// 课盘特征位。0~17 位为取传格局（ChartPattern 的值），其余为各课体条件的原子判断
+enum Feature : uint8_t {
+  PatternEnd = 18,
+  FuYinPlate = PatternEnd, // 天盘伏吟
+  FanYinPlate,             // 天盘反吟
+  InitialOvercomesStem,    // 初传克日干
+  StemOvercomesInitial,    // 日干克初传
+  InitialSelfPunish,       // 初传自刑（辰午酉亥）
+  XunQiInTransmissions,    // 旬奇入传
+  XunYiInTransmissions,    // 旬仪（旬首）入传
+  XuOnSiInTransmissions,   // 戌加巳且戌入传
+  InitialWu,               // 午发用
+  MaoAndZiInTransmissions, // 三传卯、子俱全
+  InitialMaoOnGengXin,     // 卯发用且加庚辛寄宫或申酉
+  YinCongStemOrBranch,     // 初末传引从干上或支上神
+  InitialGeneratesStem,    // 初传生日干
+  TransmissionsGenerateStem, // 三传递生日干
+  UppersGenerateOwn,       // 干上神生干、支上神生支
+  UppersGenerateOther,     // 干上神生支、支上神生干
+  InitialKuiGang,          // 辰戌发用
+  InitialOnStemOrBranch,   // 初传为干上或支上神
+  BiKouInitial,            // 旬尾加旬首发用，或旬首、旬首上神乘玄武发用
+  TransmissionsEarth,      // 三传皆土
+  InitialXunDing,          // 旬丁发用
+  DayBranchZhong,          // 日支为四仲
+  ZhongOnStemOrBranch,     // 仲神加干或支
+  TransmissionsZhong,      // 三传皆仲
+  InitialYinHe,            // 发用乘太阴、六合、朱雀或天后
+  StemOnBranch,            // 干寄宫加支
+  BranchOnStem,            // 支加干寄宫
+  BranchOvercomesStem,     // 日支克日干
+  StemOvercomesBranch,     // 日干克日支
+  InitialClashesDay,       // 发用冲干寄宫或日支
+  InitialMaoYou,           // 卯酉发用
+  LiuHeTianHou,            // 初末传分乘六合、天后
+  Incomplete,              // 四课不备
+  LessonOvercome,          // 四课有克
+  CrossOvercome,           // 干支交车相克
+  ThreeOvercome,           // 三上克下
+  ThreeThief,              // 三下贼上
+  FourThief,               // 四下贼上
+  FourOvercome,            // 四上克下
+  HarmOnStemAndBranch,     // 干上、支上各为害神
+  InitialPunishesDay,      // 发用刑干寄宫或日支
+  HourOvercomesStem,       // 占时克日干
+  DayBranchMaoYou,         // 卯酉日
+  InitialChenOnLesson,     // 辰加四课发用
+  TransmissionsChainOvercome, // 三传递克日干
+  JiuChouDay,              // 九丑日
+  HourZhong,               // 四仲时
+  ChouOnBranch,            // 丑（大吉）加日支
+  InitialTombGhost,        // 发用为日干墓神兼日鬼
+  WaterFrame,              // 三传申子辰或亥子丑
+  FireFrame,               // 三传寅午戌或巳午未
+  WoodFrame,               // 三传亥卯未或寅卯辰
+  MetalFrame,              // 三传巳酉丑或申酉戌
+  EarthFrame,              // 三传辰戌丑未取三
+  TransmissionsMeng,       // 三传皆孟
+  PlateSheng,              // 寅加亥一类，上神受下神之生
+  PlateBing,               // 寅加巳一类，上神泄于下神
+  ForwardGap,              // 三传顺间一位
+  BackwardGap,             // 三传逆间一位
+  SixYang,                 // 四课上神与三传至少六位为阳
+  SixYin,                  // 四课上神与三传至少六位为阴
+  FeatureCount,
+};
+
+static_assert(FeatureCount <= 128);
+
+// 特征位集合，两个 64 位字
+using Features = std::array<uint64_t, 2>;
+
+constexpr void set(Features &features, int feature, bool value) {
+  features[feature >> 6] |= static_cast<uint64_t>(value) << (feature & 63);
+}
+
+// 一条规则：require 中的特征位全有、exclude 中的全无时命中 type。同一课体可有多条规则，取其或
+struct Rule {
+  LessonType type;
+  Features require;
+  Features exclude;
+};
+
+constexpr Rule rule(LessonType type, std::initializer_list<int> require,
+                    std::initializer_list<int> exclude = {}) {
+  Rule r{type, {}, {}};
+  for (int f : require) {
+    set(r.require, f, true);
+  }
+  for (int f : exclude) {
+    set(r.exclude, f, true);
+  }
+  return r;
+}
+
+constexpr int pattern(ChartPattern p) { return static_cast<int>(p); }
+
+using enum LessonType;
+using P = ChartPattern;
+
+// 课体规则表，条件出自 doc/64课.md 的“课体条件”与“特殊格局及条件”两栏
+inline constexpr auto rules = std::to_array<Rule>({
+    rule(YuanShou, {pattern(P::YuanShou)}),
+    rule(ChongShen, {pattern(P::ChongShen)}),
+    rule(ZhiYi, {pattern(P::ZhiYi)}),
+    rule(SheHai, {pattern(P::SheHai)}),
+    rule(SheHai, {pattern(P::JianJi)}),
+    rule(SheHai, {pattern(P::ChaWei)}),
+    rule(SheHai, {pattern(P::FuDeng)}),
+    rule(JianJi, {pattern(P::JianJi)}),
+    rule(ChaWei, {pattern(P::ChaWei)}),
+    rule(ZhuiXia, {pattern(P::FuDeng)}),
+    rule(YaoKe, {pattern(P::YaoKe)}),
+    rule(HaoShi, {pattern(P::YaoKe), InitialOvercomesStem}),
+    rule(DanShe, {pattern(P::YaoKe)}, {InitialOvercomesStem}),
+    rule(MaoXing, {pattern(P::HuShi)}),
+    rule(MaoXing, {pattern(P::DongSheYanMu)}),
+    rule(HuShi, {pattern(P::HuShi)}),
+    rule(DongSheYanMu, {pattern(P::DongSheYanMu)}),
+    rule(BieZe, {pattern(P::BieZe)}),
+    rule(BaZhuan, {pattern(P::BaZhuan)}),
+    rule(FuYin, {FuYinPlate}),
+    rule(ZiRen, {pattern(P::FuYinGang)}),
+    rule(ZiXin, {pattern(P::FuYinRou)}),
+    rule(ZiXin, {pattern(P::FuYinYi)}),
+    rule(ZiXin, {pattern(P::FuYinGui)}),
+    rule(DuChuan, {pattern(P::FuYinGang), InitialSelfPunish}),
+    rule(DuChuan, {pattern(P::FuYinRou), InitialSelfPunish}),
+    rule(DuChuan, {pattern(P::FuYinYi), InitialSelfPunish}),
+    rule(DuChuan, {pattern(P::FuYinGui), InitialSelfPunish}),
+    rule(FanYin, {FanYinPlate}),
+    rule(WuYi, {FanYinPlate}, {pattern(P::WuQin)}),
+    rule(WuQin, {pattern(P::WuQin)}),
+    rule(SanQi, {XunQiInTransmissions}),
+    rule(LiuYi, {XunYiInTransmissions}),
+    rule(ZhuYin, {XuOnSiInTransmissions}),
+    rule(XuanGai, {InitialWu, MaoAndZiInTransmissions}),
+    rule(ZhuoLun, {InitialMaoOnGengXin}),
+    rule(YinCong, {YinCongStemOrBranch}),
+    rule(HengTong, {InitialGeneratesStem, TransmissionsGenerateStem}),
+    rule(JuSheng, {UppersGenerateOwn}),
+    rule(HuSheng, {UppersGenerateOther}),
+    rule(ZhanGuan, {InitialKuiGang, InitialOnStemOrBranch}),
+    rule(BiKou, {BiKouInitial}),
+    rule(YouZi, {TransmissionsEarth, InitialXunDing}),
+    rule(SanJiao, {DayBranchZhong, ZhongOnStemOrBranch, TransmissionsZhong, InitialYinHe}),
+    rule(LuanShou, {StemOnBranch, BranchOvercomesStem}),
+    rule(LuanShou, {BranchOnStem, BranchOvercomesStem}),
+    rule(ZhuiXu, {StemOnBranch, StemOvercomesBranch}),
+    rule(ZhuiXu, {BranchOnStem, StemOvercomesBranch}),
+    rule(ChongPo, {InitialClashesDay}),
+    rule(YinYi, {InitialMaoYou, LiuHeTianHou}),
+    rule(WuYin, {Incomplete, LessonOvercome, CrossOvercome}),
+    rule(DuE, {ThreeOvercome}),
+    rule(DuE, {ThreeThief}),
+    rule(WuLu, {FourThief}),
+    rule(JueSi, {FourOvercome}),
+    rule(QinHai, {HarmOnStemAndBranch, InitialOnStemOrBranch}),
+    rule(XingShang, {InitialPunishesDay}),
+    rule(TianWang, {HourOvercomesStem, InitialOvercomesStem}),
+    rule(LongZhan, {DayBranchMaoYou, InitialMaoYou}),
+    rule(SiQi, {InitialChenOnLesson}),
+    rule(YangJiu, {TransmissionsChainOvercome}),
+    rule(JiuChou, {JiuChouDay, HourZhong, ChouOnBranch}),
+    rule(GuiMu, {InitialTombGhost}),
+    rule(QuanJu, {WaterFrame}),
+    rule(QuanJu, {FireFrame}),
+    rule(QuanJu, {WoodFrame}),
+    rule(QuanJu, {MetalFrame}),
+    rule(QuanJu, {EarthFrame}),
+    rule(RunXia, {WaterFrame}),
+    rule(YanShang, {FireFrame}),
+    rule(QuZhi, {WoodFrame}),
+    rule(CongGe, {MetalFrame}),
+    rule(JiaSe, {EarthFrame}),
+    rule(XuanTai, {TransmissionsMeng}),
+    rule(BingTai, {TransmissionsMeng, PlateBing}),
+    rule(ShengTai, {TransmissionsMeng, PlateSheng}),
+    rule(ShunJianChuan, {ForwardGap}),
+    rule(NiJianChuan, {BackwardGap}),
+    rule(LiuYang, {SixYang}),
+    rule(LiuYin, {SixYin}),
+});
+
+// 地支集合的 12 位掩码
+constexpr uint16_t branchBits(std::initializer_list<int> branches) {
+  uint16_t bits = 0;
+  for (int b : branches) {
+    bits |= static_cast<uint16_t>(1u << b);
+  }
+  return bits;
+}
+
+inline constexpr uint16_t mengBits = branchBits({2, 5, 8, 11});   // 寅巳申亥
+inline constexpr uint16_t zhongBits = branchBits({0, 3, 6, 9});   // 子卯午酉
+inline constexpr uint16_t earthBits = branchBits({1, 4, 7, 10});  // 丑辰未戌
+inline constexpr uint16_t maoYouBits = branchBits({3, 9});
+inline constexpr uint16_t kuiGangBits = branchBits({4, 10});      // 辰戌
+
+// 九丑日：戊子、戊午、壬子、壬午、乙卯、乙酉、己卯、己酉、辛卯、辛酉，按干支序号置位
+inline constexpr uint64_t jiuChouDays = [] {
+  uint64_t days = 0;
+  constexpr int pillars[][2] = {{4, 0}, {4, 6}, {8, 0}, {8, 6}, {1, 3},
+                                {1, 9}, {5, 3}, {5, 9}, {7, 3}, {7, 9}};
+  for (auto [stem, branch] : pillars) {
+    days |= uint64_t{1} << ((6 * stem - 5 * branch + 60) % 60);
+  }
+  return days;
+}();
+
+// 三传的局：申子辰或亥子丑为水，寅午戌或巳午未为火，亥卯未或寅卯辰为木，巳酉丑或申酉戌为金
+inline constexpr std::array<std::array<uint16_t, 2>, 4> frameBits = {{
+    {branchBits({8, 0, 4}), branchBits({11, 0, 1})},
+    {branchBits({2, 6, 10}), branchBits({5, 6, 7})},
+    {branchBits({11, 3, 7}), branchBits({2, 3, 4})},
+    {branchBits({5, 9, 1}), branchBits({8, 9, 10})},
+}};
+
+// 五行之墓：木未、火戌、土辰、金丑、水辰
+inline constexpr std::array<uint8_t, 6> tombOf = {0, 7, 10, 4, 1, 4};
+
+// 求课盘的特征位
+constexpr Features features(const Chart &chart) {
+  Features f{};
+  int stem = chart.dayStem;
+  int branch = chart.dayBranch;
+  int palace = stemPalace(stem);
+  int rotation = wrap(chart.heavenPlate[0]);
+  int t0 = chart.transmissions[0];
+  int t1 = chart.transmissions[1];
+  int t2 = chart.transmissions[2];
+  int se = stemElement(stem);
+  int be = branchElement(branch);
+  int e0 = branchElement(t0);
+  int e1 = branchElement(t1);
+  int e2 = branchElement(t2);
+  int u0 = static_cast<int>(chart.upper(0));
+  int u2 = static_cast<int>(chart.upper(2));
+  uint16_t initialBit = static_cast<uint16_t>(1u << t0);
+  uint16_t trans = static_cast<uint16_t>(initialBit | 1u << t1 | 1u << t2);
+  uint16_t uppers = 0;
+  int yang = 0;
+  for (int i = 0; i < 4; ++i) {
+    int upper = static_cast<int>(chart.upper(i));
+    uppers |= static_cast<uint16_t>(1u << upper);
+    yang += upper % 2 == 0;
+  }
+  yang += (t0 % 2 == 0) + (t1 % 2 == 0) + (t2 % 2 == 0);
+  auto general = [&](int g) { return static_cast<int>(chart.generals[g]); };
+
+  // 旬首为本旬甲所临之支，旬丁、旬尾（癸）依次在其后三位、九位
+  int xunShou = wrap(branch - stem);
+  int xunQi = std::array<int, 6>{1, 1, 0, 0, 11, 11}[((6 * stem - 5 * branch + 60) % 60) / 10];
+
+  // 四课贼克
+  int thief = 0;
+  int overcome = 0;
+  uint16_t palaces = 0;
+  for (int i = 0; i < 4; ++i) {
+    int lower = chart.lower(i);
+    int le = i == 0 ? se : branchElement(lower);
+    int ue = branchElement(static_cast<int>(chart.upper(i)));
+    thief += overcomes(le, ue);
+    overcome += overcomes(ue, le);
+    palaces |= static_cast<uint16_t>(1u << (i == 0 ? palace : lower));
+  }
+
+  for (ChartPattern p : chart.patterns) {
+    set(f, static_cast<int>(p), p != ChartPattern::None);
+  }
+  set(f, FuYinPlate, rotation == 0);
+  set(f, FanYinPlate, rotation == 6);
+  set(f, InitialOvercomesStem, overcomes(e0, se));
+  set(f, StemOvercomesInitial, overcomes(se, e0));
+  set(f, InitialSelfPunish, punishment(t0) == t0);
+  set(f, XunQiInTransmissions, trans >> xunQi & 1);
+  set(f, XunYiInTransmissions, trans >> xunShou & 1);
+  set(f, XuOnSiInTransmissions, chart.heavenPlate[5] == 10 && (trans >> 10 & 1));
+  set(f, InitialWu, t0 == 6);
+  set(f, MaoAndZiInTransmissions, (trans & branchBits({3, 0})) == branchBits({3, 0}));
+  set(f, InitialMaoOnGengXin, t0 == 3 && wrap(3 - rotation) >= 8 && wrap(3 - rotation) <= 10);
+  set(f, YinCongStemOrBranch, (t0 == wrap(u0 + 1) && t2 == wrap(u0 - 1)) ||
+                                  (t0 == wrap(u2 + 1) && t2 == wrap(u2 - 1)));
+  set(f, InitialGeneratesStem, generate(e0, se));
+  set(f, TransmissionsGenerateStem,
+      (generate(e2, e1) && generate(e1, e0) && generate(e0, se)) ||
+          (generate(e0, e1) && generate(e1, e2) && generate(e2, se)));
+  set(f, UppersGenerateOwn, generate(branchElement(u0), se) && generate(branchElement(u2), be));
+  set(f, UppersGenerateOther, generate(branchElement(u0), be) && generate(branchElement(u2), se));
+  set(f, InitialKuiGang, initialBit & kuiGangBits);
+  set(f, InitialOnStemOrBranch, t0 == u0 || t0 == u2);
+  set(f, BiKouInitial,
+      (t0 == wrap(xunShou + 9) && chart.heavenPlate[xunShou] == t0) ||
+          (general(9) == t0 && (t0 == xunShou || t0 == chart.heavenPlate[xunShou])));
+  set(f, TransmissionsEarth, (trans & earthBits) == trans);
+  set(f, InitialXunDing, t0 == wrap(xunShou + 3));
+  set(f, DayBranchZhong, zhongBits >> branch & 1);
+  set(f, ZhongOnStemOrBranch, ((zhongBits >> u0) | (zhongBits >> u2)) & 1);
+  set(f, TransmissionsZhong, (trans & zhongBits) == trans);
+  set(f, InitialYinHe, general(10) == t0 || general(3) == t0 || general(2) == t0 ||
+                           general(11) == t0);
+  set(f, StemOnBranch, u2 == palace);
+  set(f, BranchOnStem, u0 == branch);
+  set(f, BranchOvercomesStem, overcomes(be, se));
+  set(f, StemOvercomesBranch, overcomes(se, be));
+  set(f, InitialClashesDay, t0 == wrap(palace + 6) || t0 == wrap(branch + 6));
+  set(f, InitialMaoYou, initialBit & maoYouBits);
+  set(f, LiuHeTianHou, (general(3) == t0 && general(11) == t2) ||
+                           (general(11) == t0 && general(3) == t2));
+  set(f, Incomplete, std::popcount(palaces) < 4);
+  set(f, LessonOvercome, thief + overcome > 0);
+  set(f, CrossOvercome, (overcomes(branchElement(u0), be) && overcomes(branchElement(u2), se)) ||
+                            (overcomes(be, branchElement(u0)) && overcomes(se, branchElement(u2))));
+  set(f, ThreeOvercome, overcome == 3);
+  set(f, ThreeThief, thief == 3);
+  set(f, FourThief, thief == 4);
+  set(f, FourOvercome, overcome == 4);
+  // 六害两支之和为 7（模 12）
+  set(f, HarmOnStemAndBranch, u0 == wrap(7 - palace) && u2 == wrap(7 - branch));
+  set(f, InitialPunishesDay, punishment(t0) == palace || punishment(t0) == branch);
+  set(f, HourOvercomesStem, overcomes(branchElement(chart.hourBranch), se));
+  set(f, DayBranchMaoYou, maoYouBits >> branch & 1);
+  set(f, InitialChenOnLesson, t0 == 4 && (uppers >> 4 & 1));
+  set(f, TransmissionsChainOvercome,
+      (overcomes(e0, e1) && overcomes(e1, e2) && overcomes(e2, se)) ||
+          (overcomes(e2, e1) && overcomes(e1, e0) && overcomes(e0, se)));
+  set(f, JiuChouDay, jiuChouDays >> ((6 * stem - 5 * branch + 60) % 60) & 1);
+  set(f, HourZhong, zhongBits >> chart.hourBranch & 1);
+  set(f, ChouOnBranch, u2 == 1);
+  set(f, InitialTombGhost, t0 == tombOf[se] && overcomes(e0, se));
+  set(f, WaterFrame, trans == frameBits[0][0] || trans == frameBits[0][1]);
+  set(f, FireFrame, trans == frameBits[1][0] || trans == frameBits[1][1]);
+  set(f, WoodFrame, trans == frameBits[2][0] || trans == frameBits[2][1]);
+  set(f, MetalFrame, trans == frameBits[3][0] || trans == frameBits[3][1]);
+  set(f, EarthFrame, (trans & earthBits) == trans && std::popcount(trans) == 3);
+  set(f, TransmissionsMeng, (trans & mengBits) == trans);
+  set(f, PlateSheng, rotation == 3);
+  set(f, PlateBing, rotation == 9);
+  set(f, ForwardGap, t1 == wrap(t0 + 2) && t2 == wrap(t1 + 2));
+  set(f, BackwardGap, t1 == wrap(t0 - 2) && t2 == wrap(t1 - 2));
+  set(f, SixYang, yang >= 6);
+  set(f, SixYin, yang <= 1);
+  return f;
+}
+
+} // namespace lesson_type_detail
+
+// 课盘命中的全部课体。课盘须含四课、三传与天将（参见 ChartFieldMask）
+constexpr LessonTypeSet classifyLessonTypes(const Chart &chart) {
+  using namespace lesson_type_detail;
+  Features f = features(chart);
+  LessonTypeSet set = 0;
+  for (const Rule &r : rules) {
+    uint64_t miss = ((f[0] & r.require[0]) ^ r.require[0]) | ((f[1] & r.require[1]) ^ r.require[1]) |
+                    (f[0] & r.exclude[0]) | (f[1] & r.exclude[1]);
+    set |= static_cast<LessonTypeSet>(miss == 0) << static_cast<int>(r.type);
+  }
+  return set;
+}
+
+static_assert(contains(classifyLessonTypes(computeChart(HeavenlyStem::Jia, EarthlyBranch::Zi,
+                                                        EarthlyBranch::Zi, EarthlyBranch::Zi)),
+                       LessonType::FuYin));
+
+namespace lesson_type_detail {
+
+// 样例课盘：日干、日支、月将、占时与应命中的课体，每个课体取 8640 课中最先命中者。
+// 复等卦不出现于 8640 课，缀瑕格无例
+struct Sample {
+  uint8_t stem;
+  uint8_t branch;
+  uint8_t moonGeneral;
+  uint8_t hour;
+  LessonType type;
+};
+
+inline constexpr Sample samples[] = {
+    {0, 0, 0, 2, YuanShou},       // 甲子日 子将 寅时
+    {0, 0, 0, 4, ChongShen},      // 甲子日 子将 辰时
+    {0, 0, 0, 1, ZhiYi},          // 甲子日 子将 丑时
+    {0, 0, 0, 6, SheHai},         // 甲子日 子将 午时
+    {4, 4, 0, 5, JianJi},         // 戊辰日 子将 巳时
+    {3, 3, 0, 11, ChaWei},        // 丁卯日 子将 亥时
+    {2, 2, 0, 3, YaoKe},          // 丙寅日 子将 卯时
+    {2, 2, 0, 3, HaoShi},         // 丙寅日 子将 卯时
+    {4, 4, 0, 8, DanShe},         // 戊辰日 子将 申时
+    {5, 5, 0, 11, MaoXing},       // 己巳日 子将 亥时
+    {6, 6, 0, 11, HuShi},         // 庚午日 子将 亥时
+    {5, 5, 0, 11, DongSheYanMu},  // 己巳日 子将 亥时
+    {4, 4, 0, 11, BieZe},         // 戊辰日 子将 亥时
+    {3, 7, 0, 1, BaZhuan},        // 丁未日 子将 丑时
+    {0, 0, 0, 0, FuYin},          // 甲子日 子将 子时
+    {0, 0, 0, 0, ZiRen},          // 甲子日 子将 子时
+    {1, 1, 0, 0, ZiXin},          // 乙丑日 子将 子时
+    {9, 1, 0, 0, ZiXin},          // 癸丑日 子将 子时
+    {1, 1, 0, 0, DuChuan},        // 乙丑日 子将 子时
+    {0, 0, 0, 6, FanYin},         // 甲子日 子将 午时
+    {0, 0, 0, 6, WuYi},           // 甲子日 子将 午时
+    {7, 7, 0, 6, WuQin},          // 辛未日 子将 午时
+    {1, 1, 0, 0, SanQi},          // 乙丑日 子将 子时
+    {0, 0, 0, 1, LiuYi},          // 甲子日 子将 丑时
+    {0, 0, 0, 7, ZhuYin},         // 甲子日 子将 未时
+    {0, 0, 0, 3, XuanGai},        // 甲子日 子将 卯时
+    {1, 1, 0, 5, ZhuoLun},        // 乙丑日 子将 巳时
+    {0, 0, 0, 1, YinCong},        // 甲子日 子将 丑时
+    {1, 1, 0, 2, HengTong},       // 乙丑日 子将 寅时
+    {0, 0, 0, 3, JuSheng},        // 甲子日 子将 卯时
+    {4, 4, 0, 11, HuSheng},       // 戊辰日 子将 亥时
+    {0, 0, 0, 2, ZhanGuan},       // 甲子日 子将 寅时
+    {0, 0, 0, 2, BiKou},          // 甲子日 子将 寅时
+    {1, 11, 0, 3, YouZi},         // 乙亥日 子将 卯时
+    {3, 3, 6, 3, SanJiao},        // 丁卯日 午将 卯时
+    {6, 6, 0, 2, LuanShou},       // 庚午日 子将 寅时
+    {1, 1, 0, 3, ZhuiXu},         // 乙丑日 子将 卯时
+    {0, 0, 0, 3, ChongPo},        // 甲子日 子将 卯时
+    {1, 1, 1, 9, YinYi},          // 乙丑日 丑将 酉时
+    {9, 9, 0, 8, WuYin},          // 癸酉日 子将 申时
+    {0, 0, 0, 5, DuE},            // 甲子日 子将 巳时
+    {6, 4, 0, 5, WuLu},           // 庚辰日 子将 巳时
+    {5, 5, 0, 5, JueSi},          // 己巳日 子将 巳时
+    {9, 1, 0, 7, QinHai},         // 癸丑日 子将 未时
+    {0, 0, 0, 9, XingShang},      // 甲子日 子将 酉时
+    {0, 0, 0, 9, TianWang},       // 甲子日 子将 酉时
+    {3, 3, 0, 0, LongZhan},       // 丁卯日 子将 子时
+    {0, 0, 0, 8, SiQi},           // 甲子日 子将 申时
+    {2, 2, 0, 5, YangJiu},        // 丙寅日 子将 巳时
+    {5, 3, 1, 3, JiuChou},        // 己卯日 丑将 卯时
+    {8, 8, 0, 7, GuiMu},          // 壬申日 子将 未时
+    {0, 0, 0, 4, QuanJu},         // 甲子日 子将 辰时
+    {0, 0, 0, 8, RunXia},         // 甲子日 子将 申时
+    {0, 0, 0, 4, YanShang},       // 甲子日 子将 辰时
+    {1, 1, 0, 11, QuZhi},         // 乙丑日 子将 亥时
+    {1, 1, 0, 4, CongGe},         // 乙丑日 子将 辰时
+    {1, 1, 0, 0, JiaSe},          // 乙丑日 子将 子时
+    {0, 0, 0, 0, XuanTai},        // 甲子日 子将 子时
+    {2, 2, 0, 3, BingTai},        // 丙寅日 子将 卯时
+    {0, 0, 0, 9, ShengTai},       // 甲子日 子将 酉时
+    {0, 0, 0, 10, ShunJianChuan}, // 甲子日 子将 戌时
+    {0, 0, 0, 2, NiJianChuan},    // 甲子日 子将 寅时
+    {0, 0, 0, 0, LiuYang},        // 甲子日 子将 子时
+    {3, 3, 0, 0, LiuYin},         // 丁卯日 子将 子时
+};
+
+constexpr Chart sampleChart(const Sample &s) {
+  return computeChart(static_cast<HeavenlyStem>(s.stem), static_cast<EarthlyBranch>(s.branch),
+                      static_cast<EarthlyBranch>(s.moonGeneral), static_cast<EarthlyBranch>(s.hour));
+}
+
+} // namespace lesson_type_detail
+
+// 各样例命中所标课体
+static_assert([] {
+  using namespace lesson_type_detail;
+  for (const Sample &s : samples) {
+    if (!contains(classifyLessonTypes(sampleChart(s)), s.type)) {
+      return false;
+    }
+  }
+  return true;
+}());
+
+// 样例合起来置遍规则所要求的每个特征位（复等卦除外）
+static_assert([] {
+  using namespace lesson_type_detail;
+  Features required{};
+  for (const Rule &r : rules) {
+    required[0] |= r.require[0];
+    required[1] |= r.require[1];
+  }
+  required[0] &= ~(uint64_t{1} << pattern(P::FuDeng));
+  Features seen{};
+  for (const Sample &s : samples) {
+    Features f = features(sampleChart(s));
+    seen[0] |= f[0];
+    seen[1] |= f[1];
+  }
+  return (required[0] & ~seen[0]) == 0 && (required[1] & ~seen[1]) == 0;
+}());
+
+#endif // DA_LIU_REN_LESSON_TYPES_HPP
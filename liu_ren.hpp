@@ -1,9 +1,14 @@
 #ifndef DA_LIU_REN_LIU_REN_HPP
 #define DA_LIU_REN_LIU_REN_HPP
 
-#include "Lunar.h" // 引入农历库头文件
+#include "lunar.h" // 引入农历库头文件
+#include "chart.hpp"
+#include "chart_context.hpp"
 #include "common.hpp"
+#include "pillar.hpp"
+#include "shen_sha.hpp"
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <codecvt>
 #include <fmt/format.h>
@@ -11,9 +16,12 @@
 #include <format>
 #include <iomanip>
 #include <iostream>
-#include <map>
+#include <optional>
+#include <print>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 using namespace std;
@@ -34,13 +42,11 @@ public:
       : lowerBranch(lower), branch(upper), isFirstOvercome(false) {}
 
   int getFiveElements() const {
-    return isFirstOvercome ? heavenlyStemFiveElements.at(stem)
-                           : earthlyBranchFiveElements.at(lowerBranch);
+    return isFirstOvercome ? fiveElement(stem) : fiveElement(lowerBranch);
   }
 
   bool isYang() const {
-    return isFirstOvercome ? heavenlyStemYinYang.at(stem)
-                           : earthlyBranchYinYang.at(lowerBranch);
+    return isFirstOvercome ? ::isYang(stem) : ::isYang(lowerBranch);
   }
 
   bool operator==(const StemBranch &other) const {
@@ -68,26 +74,22 @@ public:
         stemYangGod(sYG), branchYangGod(bYG) {}
 };
 
-// 天地盘类，包含地盘、天盘、十二神将、十二宫位对应的神煞列表和天将盘信息
+// 天地盘类，包含地盘、天盘、十二神将和天将盘信息；十二宫神煞按需由四柱查表求出
 class HeavenEarthPlate {
 public:
   std::vector<EarthlyBranch> earthPlate;     // 地盘地支数组
   std::vector<EarthlyBranch> heavenPlate;    // 天盘地支数组
   std::vector<EarthlyBranch> divineGenerals; // 十二神将位置
-  std::map<EarthlyBranch, std::vector<std::string>> shenShaTable; // 神煞表
-
-  HeavenEarthPlate(const std::vector<EarthlyBranch> &ep,
-                   const std::vector<EarthlyBranch> &hp,
-                   const std::vector<EarthlyBranch> &dg, HeavenlyStem stem,
-                   bool isDay, const LunarObj *obj)
-      : earthPlate(ep), heavenPlate(hp), divineGenerals(dg) {
-    // 获取贵人所在地支
-    auto &noblePair = nobleTable[stem];
-    EarthlyBranch noble = isDay ? noblePair.first : noblePair.second;
-    int nobleIndex = static_cast<int>(noble);
-
-    // 初始化神煞表
-    initializeShenShaTable(obj);
+  std::array<General, 12> generalOn{};       // 天盘地支 -> 所乘天将，divineGenerals 的逆置换
+  FourPillars pillars;                       // 四柱，神煞到查询或输出时才由此求出
+
+  HeavenEarthPlate(std::vector<EarthlyBranch> ep, std::vector<EarthlyBranch> hp,
+                   std::vector<EarthlyBranch> dg, const FourPillars &fp)
+      : earthPlate(std::move(ep)), heavenPlate(std::move(hp)),
+        divineGenerals(std::move(dg)), pillars(fp) {
+    for (std::size_t g = 0; g < divineGenerals.size(); ++g) {
+      generalOn[static_cast<int>(divineGenerals[g])] = static_cast<General>(g);
+    }
   }
 
   // 重载 [] 运算符，根据地支获取天盘上对应的地支
@@ -102,62 +104,50 @@ public:
     return divineGenerals[index];
   }
 
-  // 根据地支获取神煞列表
-  std::vector<std::string> getShenSha(EarthlyBranch branch) const {
-    return shenShaTable.at(branch);
+  // 获取天盘地支所乘的天将
+  General getGeneralOn(EarthlyBranch branch) const {
+    return generalOn[static_cast<int>(branch)];
   }
 
-  // 格式化输出天、地盘12宫的信息，以及十二神将位置和神煞表
-  void printPlateInfo() const {
+  // 根据地支获取该宫的神煞集合，只取三张预计算表的一行
+  ShenShaSet getShenSha(EarthlyBranch branch) const {
+    return computeShenSha(pillars, branch);
+  }
 
-    // 输出地盘信息
-    fmt::print("地盘信息: ");
-    for (const auto &branch : earthPlate) {
-      // 转换为 std::string
-      std::string branchNameStr(branchName.at(branch).begin(),
-                                branchName.at(branch).end());
-      fmt::print("{}", branchNameStr);
-      if (&branch != &earthPlate.back()) {
-        fmt::print(" ");
-      }
-    }
-    fmt::print("\n");
-
-    // 输出天盘信息
-    fmt::print("天盘信息: ");
-    for (const auto &branch : heavenPlate) {
-      // 转换为 std::string
-      std::string branchNameStr(branchName.at(branch).begin(),
-                                branchName.at(branch).end());
-      fmt::print("{}", branchNameStr);
-      if (&branch != &heavenPlate.back()) {
-        fmt::print(" ");
+  // 十二宫的神煞表，下标为地支
+  ShenShaPlate getShenShaTable() const { return computeShenSha(pillars); }
+
+  // 格式化天、地盘12宫的信息以及神煞表，写入输出迭代器
+  template <class OutputIt> OutputIt formatPlateInfo(OutputIt out) const {
+    auto formatPlate = [&](std::string_view title,
+                           const std::vector<EarthlyBranch> &plate) {
+      out = fmt::format_to(out, "{}:", title);
+      for (EarthlyBranch branch : plate) {
+        out = fmt::format_to(out, " {}", textOf(branch));
       }
+      *out++ = '\n';
+    };
+    formatPlate("地盘信息", earthPlate);
+    formatPlate("天盘信息", heavenPlate);
+
+    // 神煞表信息
+    out = fmt::format_to(out, "神煞表信息:\n");
+    ShenShaPlate shenShaTable = getShenShaTable();
+    for (int b = 0; b < 12; ++b) {
+      out = fmt::format_to(out, "地支: {} 神煞:", branchNameText[b]);
+      forEachShenSha(shenShaTable[b], [&](ShenSha sha) {
+        out = fmt::format_to(out, " {}", textOf(sha));
+      });
+      *out++ = '\n';
     }
-    fmt::print("\n");
-
-    // 输出神煞表信息
-    fmt::print("神煞表信息:\n");
-    for (const auto &[branch, shaList] : shenShaTable) {
-      // 转换为 std::string
-      std::string branchNameStr(branchName.at(branch).begin(),
-                                branchName.at(branch).end());
-      fmt::print("地支: {} 神煞: ", branchNameStr);
-      fmt::print("{}", fmt::join(shaList, " "));
-      fmt::print("\n");
-    }
+    return out;
   }
 
-private:
-  // 初始化神煞表，根据大六壬排盘规则动态生成
-  void initializeShenShaTable(const LunarObj *obj) {
-    // 获取当前年份的地支（太岁）
-    HeavenlyStem currentYearStem;
-    EarthlyBranch currentYearBranch;
-    std::u8string ganzhiYear(obj->ganzhiYear.begin(), obj->ganzhiYear.end());
-    std::u8string yearStr = ganzhiYear.substr(0, 3);
-    currentYearStem = stemMap[yearStr];
-    currentYearBranch = branchMap[ganzhiYear.substr(3, 5)];
+  // 输出天、地盘12宫的信息，以及神煞表
+  void printPlateInfo() const {
+    fmt::memory_buffer text;
+    formatPlateInfo(std::back_inserter(text));
+    std::fwrite(text.data(), 1, text.size(), stdout);
   }
 };
 
@@ -174,11 +164,11 @@ arrangeDivineGenerals(EarthlyBranch nobleBranch, bool isClockwise) {
   return divineGeneralPositions;
 }
 
-// 排列天盘
+// 排列天盘，月将加占时
 inline std::vector<EarthlyBranch>
-arrangeHeavenPlate(EarthlyBranch moonGeneral) {
+arrangeHeavenPlate(EarthlyBranch moonGeneral, EarthlyBranch hourBranch) {
   std::vector<EarthlyBranch> heavenPlateData(12);
-  EarthlyBranch current = moonGeneral;
+  EarthlyBranch current = moonGeneral + (0 - static_cast<int>(hourBranch));
   for (int i = 0; i < 12; ++i) {
     heavenPlateData[i] = current;
     current = static_cast<EarthlyBranch>((static_cast<int>(current) + 1) %
@@ -187,69 +177,13 @@ arrangeHeavenPlate(EarthlyBranch moonGeneral) {
   return heavenPlateData;
 }
 
-// 三传类，用于计算和表示三传信息
+// 三传类，用于计算和表示三传信息，取传由课表（course_table.hpp）完成
 class ThreeTransmissions {
 private:
-  const HeavenEarthPlate &heavenEarthPlate; // 引用天地盘对象
-  const FourLessons &fourLessons;           // 引用四课对象
   EarthlyBranch initial;                    // 初传
   EarthlyBranch middle;                     // 中传
   EarthlyBranch finalTransmission;          // 末传
-  std::vector<std::u8string> pattern;       // 三传的格局类型
-
-  // 去除重复课的辅助函数，避免相同天干的课重复出现
-  std::vector<StemBranch>
-  removeDuplicateLessons(const std::vector<StemBranch> &lessons) const;
-
-  // 查找有贼克的课，即地支五行克天干五行的课
-  std::vector<StemBranch> haveConquerors() const;
-
-  // 查找有克的课，即天干五行克地支五行的课
-  std::vector<StemBranch> haveOvercomes() const;
-
-  // 贼克法取三传
-  std::vector<EarthlyBranch> thiefConquer();
-
-  // 比用法取三传
-  std::vector<EarthlyBranch>
-  comparisonUse(const std::vector<StemBranch> &lessons);
-
-  // 涉害法取三传
-  std::vector<EarthlyBranch>
-  harmInvolved(const std::vector<StemBranch> &lessonsVec);
-
-  // 遥克法取三传
-  std::vector<EarthlyBranch> remoteOvercome();
-
-  // 昂星法取三传
-  std::vector<EarthlyBranch> angStar();
-
-  // 别责法取三传
-  std::vector<EarthlyBranch> specialResponsibility();
-
-  // 八专法取三传
-  std::vector<EarthlyBranch> eightSpecial();
-
-  // 伏吟法取三传
-  std::vector<EarthlyBranch> staticChant();
-
-  // 返吟法取三传
-  std::vector<EarthlyBranch> reverseChant();
-
-  // 判断地支是否为孟神（寅、巳、申、亥）
-  bool isMeng(EarthlyBranch branch) const;
-
-  // 判断地支是否为仲神（子、卯、午、酉）
-  bool isZhong(EarthlyBranch branch) const;
-
-  // 判断干支是否为八传日
-  bool isEightTransmissionDay(const StemBranch &stemBranch) const;
-
-  // 判断是否为伏吟课
-  bool isStaticChantLesson() const;
-
-  // 判断是否为返吟课
-  bool isReverseChantLesson() const;
+  std::array<ChartPattern, 2> pattern;      // 三传的格局，不足两个时以 None 补齐
 
 public:
   // 三传类构造函数，根据四课和天地盘信息计算三传
@@ -262,7 +196,7 @@ public:
   // 获取末传地支
   EarthlyBranch getFinalTransmission() const;
   // 获取三传的格局类型
-  const std::vector<std::u8string> &getPattern() const;
+  const std::array<ChartPattern, 2> &getPattern() const;
 };
 
 inline int test01() {
@@ -271,73 +205,59 @@ inline int test01() {
   std::println(std::cout, "请输入阳历日期（年 月 日 时）：");
   std::cin >> year >> month >> day >> hour;
 
-  // ---- Step 1: 使用农历库获取农历信息 ----
-  Lunar lunar;
-  LunarObj *obj = lunar.solar2lunar(year, month, day);
-
-  std::println(std::cout, "农历日期：{}年{}{}\n", obj->lunarYear,
-               obj->lunarMonthChineseName, obj->lunarDayChineseName);
-  std::println(std::cout, "生肖：{}\n", obj->animal);
-  std::println(std::cout, "干支年：{}\n", obj->ganzhiYear);
-  std::println(std::cout, "干支月：{}\n", obj->ganzhiMonth);
-  std::println(std::cout, "干支日：{}\n", obj->ganzhiDay);
-  std::println(std::cout, "节气：{}\n", obj->term);
-
-  // ---- Step 2: 更优雅地提取日干和日支 ----
-  std::u8string ganzhiDayU8 =
-      std::u8string(obj->ganzhiDay.begin(), obj->ganzhiDay.end());
-
-  if (ganzhiDayU8.length() != 6) { // 假设每个汉字UTF-8编码为3字节，总共6字节
-    throw std::runtime_error(
-        "干支日字符串长度异常，预期为两个汉字 (6字节 UTF-8)");
+  // ---- Step 1: 建日层上下文，农历信息、三柱与月将一并算好 ----
+  std::optional<DayContext> context = dayContext(year, month, day);
+  if (!context) {
+    throw std::out_of_range("阳历日期超出 1900.1.31~2100.12.31");
   }
+  const LunarDate *date = &context->date;
 
-  std::u8string stemU8Str = ganzhiDayU8.substr(0, 3);   // 截取前3个字节作为干
-  std::u8string branchU8Str = ganzhiDayU8.substr(3, 3); // 截取后3个字节作为支
+  std::println(std::cout, "农历日期：{}年{}{}\n", date->lunarYear,
+               Lunar::monthName(date->lunarMonth, date->isLeap),
+               Lunar::dayName(date->lunarDay));
+  std::println(std::cout, "生肖：{}\n", Lunar::animalName(date->lunarYear));
+  std::println(std::cout, "干支年：{}\n", Lunar::ganzhiName(date->ganzhiYear));
+  std::println(std::cout, "干支月：{}\n", Lunar::ganzhiName(date->ganzhiMonth));
+  std::println(std::cout, "干支日：{}\n", Lunar::ganzhiName(date->ganzhiDay));
+  std::println(std::cout, "节气：{}\n", Lunar::termName(date->term));
 
-  HeavenlyStem dayStem;
-  EarthlyBranch dayBranch;
+  // ---- Step 2: 日层三柱加上时柱 ----
+  FourPillars pillars = context->pillars(hour);
+  std::println(std::cout, "干支时：{}\n",
+               Lunar::ganzhiName(pillarIndex(pillars.hour)));
 
-  try {
-    dayStem = stemMap.at(stemU8Str);       // 日干
-    dayBranch = branchMap.at(branchU8Str); // 日支
-  } catch (const std::out_of_range &e) {
-    std::println(std::cerr, "Error: 干支字符无法识别: {}\n", e.what());
-    throw; // 重新抛出异常，或者进行其他错误处理
-  }
+  HeavenlyStem dayStem = pillars.day.stem;       // 日干
+  EarthlyBranch dayBranch = pillars.day.branch;  // 日支
 
-  // 时辰计算
-  EarthlyBranch timePeriod = static_cast<EarthlyBranch>((hour + 1) / 2 % 12);
   // 当前时辰用于判断昼夜
-  EarthlyBranch currentHour = timePeriod;
+  EarthlyBranch currentHour = pillars.hour.branch;
 
-  // ---- Step 3: 确定贵人 ----
+  // ---- Step 3: 确定贵人，日层已备好昼夜贵人，按占时取其一 ----
   bool isDay = isDaytime(currentHour);
+  EarthlyBranch nobleBranch = context->noble(hour);
 
   // ---- Step 4: 排列十二神将 ----
-  EarthlyBranch nobleBranch = getNoble(dayStem, isDay);
-  bool isClockwise =
-      (nobleBranch == EarthlyBranch::Hai) ||
-      (static_cast<int>(nobleBranch) >= static_cast<int>(EarthlyBranch::Zi) &&
-       static_cast<int>(nobleBranch) <= static_cast<int>(EarthlyBranch::Chen));
+  bool isClockwise = isNobleClockwise(dayStem, isDay);
 
   std::vector<EarthlyBranch> divineGeneralPositions =
       arrangeDivineGenerals(nobleBranch, isClockwise);
 
   // ---- Step 5: 获取月将 ----
-  EarthlyBranch moonGeneral = getMoonGeneral(obj);
+  EarthlyBranch moonGeneral = context->month.moonGeneral;
 
   // ---- Step 6: 初始化天盘 ----
-  std::vector<EarthlyBranch> heavenPlateData = arrangeHeavenPlate(moonGeneral);
+  std::vector<EarthlyBranch> heavenPlateData =
+      arrangeHeavenPlate(moonGeneral, currentHour);
 
   // ---- Step 7: 创建天地盘对象 ----
-  HeavenEarthPlate heavenEarthPlate(earthPlateData, heavenPlateData,
-                                    divineGeneralPositions, dayStem, isDay,
-                                    obj);
+  std::vector<EarthlyBranch> earthPlate(earthPlateData.begin(),
+                                        earthPlateData.end());
+  HeavenEarthPlate heavenEarthPlate(std::move(earthPlate), std::move(heavenPlateData),
+                                    std::move(divineGeneralPositions), pillars);
 
   // ---- Step 8: 计算四课 ----
-  // 第一课：干上神
-  EarthlyBranch dayStemPalace = getPalace(dayStem);
+  // 第一课：干上神，日干寄宫取自日层
+  EarthlyBranch dayStemPalace = context->stemPalace;
   EarthlyBranch firstLessonUpperGod = heavenEarthPlate[dayStemPalace];
   StemBranch firstLesson(dayStem, firstLessonUpperGod);
 
@@ -364,38 +284,22 @@ inline int test01() {
   // 创建三传对象
   ThreeTransmissions threeTransmissions(heavenEarthPlate, fourLessonsObj);
 
-  // 输出初传地支编号
-  std::cout << std::format(
-                   "初传: {}\n",
-                   std::string(
-                       branchName[threeTransmissions.getInitial()].begin(),
-                       branchName[threeTransmissions.getInitial()].end()))
-            << std::endl;
-
-  // 输出中传地支编号
-  std::cout << std::format(
-                   "中传: {}\n",
-                   std::string(
-                       branchName[threeTransmissions.getMiddle()].begin(),
-                       branchName[threeTransmissions.getMiddle()].end()))
-            << std::endl;
-
-  // 输出末传地支编号
-  std::cout
-      << std::format(
-             "末传: {}\n",
-             std::string(
-                 branchName[threeTransmissions.getFinalTransmission()].begin(),
-                 branchName[threeTransmissions.getFinalTransmission()].end()))
-      << std::endl;
-
-  // 输出三传的格局类型
-  for (const auto &p : threeTransmissions.getPattern()) {
-    std::cout << std::format("格局: {}\n", std::string(p.begin(), p.end()))
-              << std::endl; // Convert to std::string for formatting
+  // 三传、格局与天地盘一并格式化后一次写出
+  fmt::memory_buffer text;
+  auto out = std::back_inserter(text);
+  out = fmt::format_to(out, "初传: {}\n\n中传: {}\n\n末传: {}\n\n",
+                       textOf(threeTransmissions.getInitial()),
+                       textOf(threeTransmissions.getMiddle()),
+                       textOf(threeTransmissions.getFinalTransmission()));
+  for (ChartPattern p : threeTransmissions.getPattern()) {
+    if (p != ChartPattern::None) {
+      out = fmt::format_to(out, "格局: {}\n\n", textOf(p));
+    }
   }
-
-  heavenEarthPlate.printPlateInfo();
+  heavenEarthPlate.formatPlateInfo(out);
+  std::cout << std::flush;
+  std::fwrite(text.data(), 1, text.size(), stdout);
+  std::fflush(stdout);
 
   return 0;
 }
@@ -1,14 +1,114 @@
-
+#include "chart_archive.hpp"
+#include "chart_format.hpp"
 #include "liu_ren.hpp"
+#include "pipeline.hpp"
+#include "server.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <string_view>
+#include <system_error>
 
 using namespace std;
 
+// 批处理模式：da_liu_ren --batch [文件] [--format=ndjson|csv|binary] [--threads=N] [--archive=存档]
+// [--fields=plate,lessons,...]，无文件时读标准输入；指定存档时课盘写入列式存档
+static int runBatch(int argc, char **argv) {
+  PipelineOptions options;
+  const char *path = nullptr;
+  const char *archivePath = nullptr;
+  for (int i = 2; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg == "--format=csv") {
+      options.format = OutputFormat::Csv;
+    } else if (arg == "--format=binary") {
+      options.format = OutputFormat::Binary;
+    } else if (arg == "--format=ndjson") {
+      options.format = OutputFormat::NdJson;
+    } else if (arg.starts_with("--threads=")) {
+      options.threads = static_cast<unsigned>(std::atoi(argv[i] + 10));
+    } else if (arg.starts_with("--archive=")) {
+      archivePath = argv[i] + 10;
+    } else if (arg.starts_with("--fields=")) {
+      if (!parseChartFields(arg.substr(9), options.fields)) {
+        std::println(std::cerr, "未知字段：{}", arg.substr(9));
+        return 2;
+      }
+    } else if (!arg.starts_with("--") && path == nullptr) {
+      path = argv[i];
+    } else {
+      std::println(std::cerr, "未知参数：{}", arg);
+      return 2;
+    }
+  }
+  std::ios::sync_with_stdio(false);
+  std::ifstream file;
+  if (path != nullptr) {
+    file.open(path);
+    if (!file) {
+      std::println(std::cerr, "无法打开输入文件：{}", path);
+      return 2;
+    }
+  }
+  std::optional<ChartArchiveWriter> archive;
+  std::size_t failed = 0;
+  try {
+    if (archivePath != nullptr) {
+      archive.emplace(archivePath);
+      options.archive = &*archive;
+    }
+    failed = runPipeline(path ? file : std::cin, stdout, options);
+    if (archive) {
+      archive->close();
+    }
+  } catch (const std::system_error &error) {
+    std::println(std::cerr, "写出出错：{}", error.what());
+    return 1;
+  }
+  return failed == 0 ? 0 : 1;
+}
 
+// 守护进程模式：da_liu_ren --serve 套接字路径 [--threads=N] [--fields=plate,lessons,...]
+static int runServe(int argc, char **argv) {
+  ServerOptions options;
+  for (int i = 2; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg.starts_with("--threads=")) {
+      options.threads = static_cast<unsigned>(std::atoi(argv[i] + 10));
+    } else if (arg.starts_with("--fields=")) {
+      if (!parseChartFields(arg.substr(9), options.fields)) {
+        std::println(std::cerr, "未知字段：{}", arg.substr(9));
+        return 2;
+      }
+    } else if (!arg.starts_with("--") && options.socketPath.empty()) {
+      options.socketPath = arg;
+    } else {
+      std::println(std::cerr, "未知参数：{}", arg);
+      return 2;
+    }
+  }
+  if (options.socketPath.empty()) {
+    std::println(std::cerr, "用法：da_liu_ren --serve 套接字路径 [--threads=N] [--fields=...]");
+    return 2;
+  }
+  try {
+    runServer(options);
+  } catch (const std::exception &error) {
+    std::println(std::cerr, "守护进程出错：{}", error.what());
+    return 1;
+  }
+  return 0;
+}
 
-int main() {
+int main(int argc, char **argv) {
+  if (argc > 1 && std::string_view(argv[1]) == "--batch") {
+    return runBatch(argc, argv);
+  }
+  if (argc > 1 && std::string_view(argv[1]) == "--serve") {
+    return runServe(argc, argv);
+  }
   // 设置本地化环境
   std::locale::global(std::locale(""));
   std::cout.imbue(std::locale());
   test01();
 
-}
\ No newline at end of file
+}
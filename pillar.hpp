@@ -0,0 +1,68 @@
+//
+// 四柱干支：直接由整数日序号与钟点推算年、月、日、时四柱
+//
+
+#ifndef DA_LIU_REN_PILLAR_HPP
+#define DA_LIU_REN_PILLAR_HPP
+
+#include "common.hpp"
+#include "lunar.h"
+#include <cstdint>
+
+// 一柱干支
+struct Pillar {
+  HeavenlyStem stem;
+  EarthlyBranch branch;
+};
+
+// 年、月、日、时四柱
+struct FourPillars {
+  Pillar year;
+  Pillar month;
+  Pillar day;
+  Pillar hour;
+};
+
+// 干支序号（0 为甲子，0~59）转为一柱
+constexpr Pillar pillarOf(int index) {
+  return {static_cast<HeavenlyStem>(index % 10),
+          static_cast<EarthlyBranch>(index % 12)};
+}
+
+// 一柱转为干支序号（0 为甲子），干支阴阳不同时无意义
+constexpr int pillarIndex(Pillar pillar) {
+  int stem = static_cast<int>(pillar.stem);
+  int branch = static_cast<int>(pillar.branch);
+  return (6 * stem - 5 * branch + 60) % 60;
+}
+
+// 日柱，dayNumber 为距 1900.1.31（甲辰日）的天数，参见 Lunar::dayNumber
+constexpr Pillar dayPillar(int32_t dayNumber) {
+  return pillarOf(((dayNumber + 40) % 60 + 60) % 60);
+}
+
+// 时辰地支，子时跨 23~1 点
+constexpr EarthlyBranch hourBranchOf(int hour) {
+  return static_cast<EarthlyBranch>((hour + 1) / 2 % 12);
+}
+
+// 时柱，按五鼠遁由日干起时干：甲己起甲子，乙庚起丙子，丙辛起戊子，丁壬起庚子，戊癸起壬子
+constexpr Pillar hourPillar(HeavenlyStem dayStem, int hour) {
+  EarthlyBranch branch = hourBranchOf(hour);
+  int stem = (static_cast<int>(dayStem) % 5 * 2 + static_cast<int>(branch)) % 10;
+  return {static_cast<HeavenlyStem>(stem), branch};
+}
+
+// 由农历信息中的干支序号与钟点得到四柱
+constexpr FourPillars fourPillars(const LunarDate &date, int hour) {
+  Pillar day = pillarOf(date.ganzhiDay);
+  return {pillarOf(date.ganzhiYear), pillarOf(date.ganzhiMonth), day,
+          hourPillar(day.stem, hour)};
+}
+
+static_assert(pillarIndex(pillarOf(59)) == 59);
+static_assert(dayPillar(0).stem == HeavenlyStem::Jia &&
+              dayPillar(0).branch == EarthlyBranch::Chen);
+static_assert(hourPillar(HeavenlyStem::Wu, 0).stem == HeavenlyStem::Ren);
+
+#endif // DA_LIU_REN_PILLAR_HPP
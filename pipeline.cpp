@@ -0,0 +1,177 @@
+#include "pipeline.hpp"
+#include "bounded_queue.hpp"
+#include "chart_archive.hpp"
+#include "chart_format.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 一块输入与其序列化结果
+struct Block {
+  std::size_t sequence = 0;
+  std::vector<ChartRequest> lines;
+  std::vector<Chart> charts; // 写存档时使用
+  fmt::memory_buffer text;
+  std::size_t failed = 0;
+};
+
+// 写出失败时按 errno 抛出，与存档写出的错误走同一路径；缓冲中的错误可能到 fflush 才出现
+[[noreturn]] void throwWriteError() {
+  throw std::system_error(errno != 0 ? errno : EIO, std::generic_category(), "runPipeline: 写出");
+}
+
+void writeText(std::FILE *output, std::string_view text) {
+  if (std::fwrite(text.data(), 1, text.size(), output) != text.size()) {
+    throwWriteError();
+  }
+}
+
+} // namespace
+
+std::size_t runPipeline(std::istream &input, std::FILE *output, const PipelineOptions &options) {
+  unsigned threads = options.threads;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::size_t linesPerBlock = std::max<std::size_t>(options.linesPerBlock, 1);
+  std::size_t inFlight = options.blocksInFlight ? options.blocksInFlight : threads * 4;
+  ChartFieldMask fields = options.format == OutputFormat::Binary || options.archive != nullptr
+                              ? chartFieldsInChart
+                              : options.fields;
+  auto serialize = options.format == OutputFormat::Csv      ? writeChartCsv
+                   : options.format == OutputFormat::Binary ? writeChartRecord
+                                                            : writeChartJson;
+
+  // 已读入未写出的块数受信号量限制，写线程按序号取 slots 中的结果，不会冲突
+  std::counting_semaphore<> credits(static_cast<std::ptrdiff_t>(inFlight));
+  BoundedQueue<Block> parsed(inFlight);
+  std::vector<std::optional<Block>> slots(inFlight);
+  std::mutex slotMutex;
+  std::condition_variable slotReady;
+  std::size_t blockCount = 0;
+  bool inputDone = false;
+  // 写出出错后置位：读线程不再读入，写线程只回收已提交的块
+  std::atomic<bool> cancelled = false;
+
+  std::jthread reader([&] {
+    std::string line;
+    std::size_t lineNumber = 0;
+    std::size_t sequence = 0;
+    Block block;
+    auto flush = [&] {
+      credits.acquire();
+      block.sequence = sequence++;
+      parsed.push(std::move(block));
+      block.lines.clear();
+      block.lines.reserve(linesPerBlock);
+      block.text.clear();
+    };
+    block.lines.reserve(linesPerBlock);
+    while (!cancelled.load(std::memory_order_relaxed) && std::getline(input, line)) {
+      ++lineNumber;
+      if (line.find_first_not_of(" \t\r") == std::string::npos) {
+        continue;
+      }
+      ChartRequest &entry = block.lines.emplace_back(ChartRequest{lineNumber, {}, false});
+      entry.valid = parseChartInput(line, entry.input);
+      if (block.lines.size() == linesPerBlock) {
+        flush();
+      }
+    }
+    if (!block.lines.empty()) {
+      flush();
+    }
+    parsed.close();
+    std::lock_guard lock(slotMutex);
+    blockCount = sequence;
+    inputDone = true;
+    slotReady.notify_all();
+  });
+
+  std::vector<std::jthread> workers;
+  for (unsigned w = 0; w < threads; ++w) {
+    workers.emplace_back([&] {
+      while (std::optional<Block> block = parsed.pop()) {
+        for (const ChartRequest &line : block->lines) {
+          ShenShaPlate shenSha;
+          std::optional<Chart> chart =
+              line.valid ? chartAt(line.input, fields, &shenSha) : std::nullopt;
+          block->failed += !chart;
+          if (options.archive != nullptr) {
+            block->charts.push_back(chart.value_or(Chart{}));
+          } else {
+            serialize(block->text, line, chart, fields, &shenSha);
+          }
+        }
+        std::size_t slot = block->sequence % inFlight;
+        std::lock_guard lock(slotMutex);
+        slots[slot] = std::move(block);
+        slotReady.notify_all();
+      }
+    });
+  }
+
+  // 写出：本线程按序号顺序等待各块，每块整体一次写出。首次出错后不再写，只回收余下的块
+  std::exception_ptr error;
+  auto write = [&](auto &&action) {
+    if (error) {
+      return;
+    }
+    try {
+      action();
+    } catch (...) {
+      error = std::current_exception();
+      cancelled = true;
+    }
+  };
+  if (options.format == OutputFormat::Csv && options.archive == nullptr) {
+    write([&] { writeText(output, chartCsvHeader); });
+  }
+  std::size_t failed = 0;
+  for (std::size_t next = 0;; ++next) {
+    Block block;
+    {
+      std::unique_lock lock(slotMutex);
+      slotReady.wait(lock, [&] {
+        return slots[next % inFlight].has_value() || (inputDone && next >= blockCount);
+      });
+      if (!slots[next % inFlight]) {
+        break;
+      }
+      block = std::move(*slots[next % inFlight]);
+      slots[next % inFlight].reset();
+    }
+    write([&] {
+      if (options.archive != nullptr) {
+        options.archive->append(block.charts);
+      } else {
+        writeText(output, std::string_view(block.text.data(), block.text.size()));
+      }
+    });
+    failed += block.failed;
+    credits.release();
+  }
+  write([&] {
+    if (std::fflush(output) != 0 || std::ferror(output)) {
+      throwWriteError();
+    }
+  });
+  if (error) {
+    reader.join();
+    workers.clear();
+    std::rethrow_exception(error);
+  }
+  return failed;
+}
@@ -0,0 +1,34 @@
+//
+// 批处理流水线：读线程按块切分输入，计算线程池起课并序列化，写线程按输入顺序输出
+//
+
+#ifndef DA_LIU_REN_PIPELINE_HPP
+#define DA_LIU_REN_PIPELINE_HPP
+
+#include "chart.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <istream>
+
+class ChartArchiveWriter;
+
+// 输出格式：每行一个 JSON 对象、带表头的 CSV，或每行一条定长二进制记录（参见 chart_format.hpp）
+enum class OutputFormat { NdJson, Csv, Binary };
+
+struct PipelineOptions {
+  OutputFormat format = OutputFormat::NdJson;
+  unsigned threads = 0;          // 计算线程数，0 取硬件并发数
+  std::size_t linesPerBlock = 4096;
+  std::size_t blocksInFlight = 0; // 已读入未写出的块数上限，0 取计算线程数的 4 倍
+  ChartArchiveWriter *archive = nullptr; // 非空时课盘按输入顺序写入列式存档，不输出文本
+  // 只输出这些部分，神煞须显式要求；二进制记录与存档总为完整课盘
+  ChartFieldMask fields = chartFieldsInChart;
+};
+
+// 逐行读取“年 月 日 时”（分隔符可为空格、逗号、-、T、:，多余字段忽略），
+// 每个非空行输出一行结果，无法解析或超出范围的行输出 error 字段。返回出错行数。
+// 写存档或写 output 出错（含短写与末尾 fflush 失败）时停止读入，等各线程退出后重新抛出该异常，
+// output 的写出错误为 std::system_error
+std::size_t runPipeline(std::istream &input, std::FILE *output, const PipelineOptions &options);
+
+#endif // DA_LIU_REN_PIPELINE_HPP
@@ -0,0 +1,429 @@
+#include "server.hpp"
+#include "bounded_queue.hpp"
+#include "chart_format.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+// 一行请求的长度上限，超出即应答一条错误记录，不再读取该连接，应答写完后断开
+constexpr std::size_t maxLineLength = 256;
+
+// 每个连接积压应答的上限：已排队待写的字节加上未算完的请求（按 chartJsonMaxSize 估计）。
+// 达到上限即暂停读取该连接，对端读走应答后再恢复
+constexpr std::size_t maxBacklog = std::size_t{1} << 22;
+
+// epoll 事件数据中的保留编号，客户端连接自 firstClient 起编号
+constexpr uint64_t listenId = 0;
+constexpr uint64_t signalId = 1;
+constexpr uint64_t completionId = 2;
+constexpr uint64_t firstClient = 3;
+
+[[noreturn]] void fail(const char *what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+// 自动关闭的文件描述符
+struct FileDescriptor {
+  int fd = -1;
+
+  explicit FileDescriptor(int fd) : fd(fd) {}
+  FileDescriptor(FileDescriptor &&other) noexcept : fd(std::exchange(other.fd, -1)) {}
+  FileDescriptor(const FileDescriptor &) = delete;
+  ~FileDescriptor() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+};
+
+struct Connection {
+  FileDescriptor socket;
+  std::string input{};         // 尚未成行的输入
+  std::string output{};        // 尚未写出的应答
+  std::size_t nextLine = 1;    // 下一请求的序号
+  std::size_t pending = 0;     // 已提交未应答的请求数
+  bool readClosed = false;     // 对端已关闭写端、读出错或行过长，不再读取
+  uint32_t events = EPOLLIN;   // 当前注册的 epoll 事件
+
+  // 积压已满，暂不读取
+  bool backlogged() const { return output.size() + pending * chartJsonMaxSize >= maxBacklog; }
+};
+
+// 一批请求：来自若干连接，计算线程填写 text 与各请求应答的结束位置
+struct Batch {
+  std::size_t sequence = 0;
+  std::vector<uint64_t> connections;
+  std::vector<ChartRequest> requests;
+  fmt::memory_buffer text;
+  std::vector<std::size_t> ends;
+};
+
+class Server {
+public:
+  Server(const ServerOptions &options, const sigset_t &signals)
+      : options(options), listener(::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)),
+        signalFd(::signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC)),
+        completionFd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+        epollFd(::epoll_create1(EPOLL_CLOEXEC)),
+        work(std::max(1u, options.threads) * 4) {
+    if (listener.fd < 0 || signalFd.fd < 0 || completionFd.fd < 0 || epollFd.fd < 0) {
+      fail("runServer");
+    }
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.size() >= sizeof(address.sun_path)) {
+      throw std::invalid_argument("runServer: 套接字路径过长");
+    }
+    std::memcpy(address.sun_path, options.socketPath.c_str(), options.socketPath.size() + 1);
+    // 路径上残留的套接字（上次未清理）可以删除，其他文件不覆盖
+    struct stat existing;
+    if (::lstat(options.socketPath.c_str(), &existing) == 0) {
+      if (!S_ISSOCK(existing.st_mode)) {
+        throw std::invalid_argument("runServer: 路径已存在且不是套接字");
+      }
+      ::unlink(options.socketPath.c_str());
+    }
+    if (::bind(listener.fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+      fail("runServer: bind");
+    }
+    struct stat created;
+    if (::lstat(options.socketPath.c_str(), &created) == 0) {
+      boundFile = {created.st_dev, created.st_ino};
+    }
+    if (::listen(listener.fd, SOMAXCONN) < 0) {
+      fail("runServer: listen");
+    }
+    watch(listener.fd, listenId, EPOLLIN);
+    watch(signalFd.fd, signalId, EPOLLIN);
+    watch(completionFd.fd, completionId, EPOLLIN);
+  }
+
+  // 只删除本进程绑定的那个套接字文件；路径已被替换为其他文件时保留
+  ~Server() {
+    struct stat current;
+    if (boundFile && ::lstat(options.socketPath.c_str(), &current) == 0 &&
+        S_ISSOCK(current.st_mode) && *boundFile == std::pair(current.st_dev, current.st_ino)) {
+      ::unlink(options.socketPath.c_str());
+    }
+  }
+
+  void run() {
+    std::vector<std::jthread> workers;
+    for (unsigned w = 0; w < std::max(1u, options.threads); ++w) {
+      workers.emplace_back([this] { computeLoop(); });
+    }
+    try {
+      loop();
+    } catch (...) {
+      work.close();
+      throw;
+    }
+    work.close();
+  }
+
+private:
+  void loop() {
+    std::array<epoll_event, 256> events;
+    bool stopping = false;
+    while (!stopping) {
+      int count = ::epoll_wait(epollFd.fd, events.data(), static_cast<int>(events.size()), -1);
+      if (count < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        fail("epoll_wait");
+      }
+      for (int e = 0; e < count; ++e) {
+        uint64_t id = events[e].data.u64;
+        if (id == listenId) {
+          acceptAll();
+        } else if (id == signalId) {
+          stopping = true;
+        } else if (id == completionId) {
+          applyCompletions();
+        } else if (events[e].events & (EPOLLHUP | EPOLLERR)) {
+          connections.erase(id); // 对端两个方向都已关闭，应答无从送达
+        } else {
+          if (events[e].events & EPOLLIN) {
+            readFrom(id);
+          }
+          if (events[e].events & EPOLLOUT) {
+            flush(id);
+          }
+        }
+      }
+      submit();
+    }
+  }
+
+  void watch(int fd, uint64_t id, uint32_t events, int op = EPOLL_CTL_ADD) {
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = id;
+    if (::epoll_ctl(epollFd.fd, op, fd, &event) < 0) {
+      fail("epoll_ctl");
+    }
+  }
+
+  void acceptAll() {
+    for (;;) {
+      int fd = ::accept4(listener.fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNABORTED) {
+          return;
+        }
+        fail("accept4");
+      }
+      uint64_t id = nextClient++;
+      connections.emplace(id, Connection{.socket = FileDescriptor(fd)});
+      watch(fd, id, EPOLLIN);
+    }
+  }
+
+  // 读取可读数据并把完整的行加入当前批，积压已满时留待下次。读到结尾时末行不带换行也作一个请求
+  void readFrom(uint64_t id) {
+    auto it = connections.find(id);
+    if (it == connections.end()) {
+      return;
+    }
+    Connection &connection = it->second;
+    char buffer[16384];
+    while (!connection.readClosed && !connection.backlogged()) {
+      ssize_t n = ::read(connection.socket.fd, buffer, sizeof(buffer));
+      if (n > 0) {
+        connection.input.append(buffer, static_cast<std::size_t>(n));
+        takeLines(id, connection, false);
+        continue;
+      }
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        break;
+      }
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n == 0) {
+        takeLines(id, connection, true);
+      }
+      connection.readClosed = true; // 读到结尾或出错
+    }
+    updateEvents(id, connection);
+    closeIfDone(id);
+  }
+
+  // 取出 input 中完整的行，atEnd 时连同末尾不带换行的部分。遇到超过 maxLineLength 的行
+  // （含尚未成行但已超长的部分）时，为其应答一条错误记录，丢弃其后的输入并停止读取
+  void takeLines(uint64_t id, Connection &connection, bool atEnd) {
+    std::string_view input = connection.input;
+    std::size_t start = 0;
+    while (start < input.size()) {
+      std::size_t end = input.find('\n', start);
+      if (end == std::string_view::npos) {
+        if (!atEnd && input.size() - start <= maxLineLength) {
+          break;
+        }
+        end = input.size();
+      }
+      std::string_view line = input.substr(start, end - start);
+      start = std::min(end + 1, input.size());
+      if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+        continue;
+      }
+      ChartRequest request{connection.nextLine++, {}, false};
+      request.valid = line.size() <= maxLineLength && parseChartInput(line, request.input);
+      ++connection.pending;
+      pending.connections.push_back(id);
+      pending.requests.push_back(request);
+      if (pending.requests.size() >= options.maxBatch) {
+        submit();
+      }
+      if (line.size() > maxLineLength) {
+        connection.readClosed = true;
+        connection.input.clear();
+        return;
+      }
+    }
+    connection.input.erase(0, start);
+  }
+
+  // 按连接状态注册事件：仍在读且积压未满时读，有待写的应答时写
+  void updateEvents(uint64_t id, Connection &connection) {
+    uint32_t wanted = 0;
+    if (!connection.readClosed && !connection.backlogged()) {
+      wanted |= EPOLLIN;
+    }
+    if (!connection.output.empty()) {
+      wanted |= EPOLLOUT;
+    }
+    if (wanted != connection.events) {
+      watch(connection.socket.fd, id, wanted, EPOLL_CTL_MOD);
+      connection.events = wanted;
+    }
+  }
+
+  // 交出当前批
+  void submit() {
+    if (pending.requests.empty()) {
+      return;
+    }
+    pending.sequence = submitted++;
+    work.push(std::move(pending));
+    pending.connections.clear();
+    pending.requests.clear();
+  }
+
+  void computeLoop() {
+    while (std::optional<Batch> batch = work.pop()) {
+      batch->ends.reserve(batch->requests.size());
+      for (const ChartRequest &request : batch->requests) {
+        ShenShaPlate shenSha;
+        std::optional<Chart> chart =
+            request.valid ? chartAt(request.input, options.fields, &shenSha) : std::nullopt;
+        writeChartJson(batch->text, request, chart, options.fields, &shenSha);
+        batch->ends.push_back(batch->text.size());
+      }
+      {
+        std::lock_guard lock(doneMutex);
+        done.emplace(batch->sequence, std::move(*batch));
+      }
+      uint64_t one = 1;
+      [[maybe_unused]] ssize_t written = ::write(completionFd.fd, &one, sizeof(one));
+    }
+  }
+
+  // 按批序号依次把应答追加到各连接，保证每个连接内的应答顺序
+  void applyCompletions() {
+    uint64_t counter;
+    [[maybe_unused]] ssize_t n = ::read(completionFd.fd, &counter, sizeof(counter));
+    std::vector<uint64_t> touched;
+    for (;;) {
+      Batch batch;
+      {
+        std::lock_guard lock(doneMutex);
+        auto it = done.find(applied);
+        if (it == done.end()) {
+          break;
+        }
+        batch = std::move(it->second);
+        done.erase(it);
+      }
+      ++applied;
+      std::size_t begin = 0;
+      for (std::size_t i = 0; i < batch.requests.size(); ++i) {
+        auto it = connections.find(batch.connections[i]);
+        if (it != connections.end()) {
+          it->second.output.append(batch.text.data() + begin, batch.ends[i] - begin);
+          --it->second.pending;
+          touched.push_back(batch.connections[i]);
+        }
+        begin = batch.ends[i];
+      }
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (uint64_t id : touched) {
+      flush(id);
+    }
+  }
+
+  // 尽量写出应答，写不完时注册 EPOLLOUT
+  void flush(uint64_t id) {
+    auto it = connections.find(id);
+    if (it == connections.end()) {
+      return;
+    }
+    Connection &connection = it->second;
+    std::size_t written = 0;
+    while (written < connection.output.size()) {
+      ssize_t n = ::send(connection.socket.fd, connection.output.data() + written,
+                         connection.output.size() - written, MSG_NOSIGNAL);
+      if (n > 0) {
+        written += static_cast<std::size_t>(n);
+      } else if (n < 0 && errno == EINTR) {
+        continue;
+      } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        break;
+      } else {
+        connections.erase(it); // 对端已断开
+        return;
+      }
+    }
+    connection.output.erase(0, written);
+    updateEvents(id, connection);
+    closeIfDone(id);
+  }
+
+  void closeIfDone(uint64_t id) {
+    auto it = connections.find(id);
+    if (it != connections.end() && it->second.readClosed && it->second.pending == 0 &&
+        it->second.output.empty()) {
+      connections.erase(it);
+    }
+  }
+
+  const ServerOptions &options;
+  FileDescriptor listener, signalFd, completionFd, epollFd;
+  std::optional<std::pair<dev_t, ino_t>> boundFile; // 绑定时套接字文件的设备号与 inode
+  std::unordered_map<uint64_t, Connection> connections;
+  uint64_t nextClient = firstClient;
+  Batch pending;
+  std::size_t submitted = 0;
+  std::size_t applied = 0;
+  BoundedQueue<Batch> work;
+  std::mutex doneMutex;
+  std::map<std::size_t, Batch> done;
+};
+
+} // namespace
+
+void runServer(const ServerOptions &options) {
+  ServerOptions resolved = options;
+  if (resolved.threads == 0) {
+    resolved.threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  resolved.maxBatch = std::max<std::size_t>(resolved.maxBatch, 1);
+  // 由 signalfd 接收退出信号，须在起线程前屏蔽
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  sigset_t previous;
+  pthread_sigmask(SIG_BLOCK, &signals, &previous);
+  {
+    Server server(resolved, signals);
+    server.run();
+  }
+  pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+}
+
+#else
+
+void runServer(const ServerOptions &) {
+  throw std::runtime_error("runServer: 仅支持 Linux");
+}
+
+#endif // __linux__
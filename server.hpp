@@ -0,0 +1,26 @@
+//
+// 本地守护进程：监听 Unix 域套接字，逐行接收“年 月 日 时”，以 NDJSON 逐行应答
+//
+
+#ifndef DA_LIU_REN_SERVER_HPP
+#define DA_LIU_REN_SERVER_HPP
+
+#include "chart.hpp"
+#include <cstddef>
+#include <string>
+
+struct ServerOptions {
+  std::string socketPath;
+  unsigned threads = 0;        // 计算线程数，0 取硬件并发数
+  std::size_t maxBatch = 1024; // 一批最多合并的请求数
+  // 应答中只含这些部分，起课只算其依赖；神煞须显式要求
+  ChartFieldMask fields = chartFieldsInChart;
+};
+
+// 运行守护进程直至收到 SIGINT 或 SIGTERM。同一轮 epoll 就绪的全部请求合并为批交给计算线程，
+// 每个连接内按请求顺序应答；对端不读应答时积压到上限即暂停读取该连接。
+// 仅支持 Linux；套接字操作失败时抛出 std::system_error，路径上已有非套接字文件时抛出
+// std::invalid_argument
+void runServer(const ServerOptions &options);
+
+#endif // DA_LIU_REN_SERVER_HPP
@@ -0,0 +1,242 @@
+//
+// 神煞：按太岁（年支）、月建（月支）与日干支各自预先求出十二宫的神煞位集，
+// 一课只需把三张表的对应行按宫相或；神煞名称到输出时才查表
+//
+
+#ifndef DA_LIU_REN_SHEN_SHA_HPP
+#define DA_LIU_REN_SHEN_SHA_HPP
+
+#include "chart.hpp"
+#include "pillar.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+// 神煞编号，依年煞、季煞、月煞、日煞、支煞、旬煞排列
+enum class ShenSha : uint8_t {
+  TaiSui,   // 太岁：年支
+  SuiPo,    // 岁破（大耗）：太岁对冲
+  BingFu,   // 病符：旧太岁
+  SangMen,  // 丧门：岁前二辰
+  DiaoKe,   // 吊客：岁后二辰
+  SuiHu,    // 岁虎：岁后四辰
+  GuChen,   // 孤神：寅卯辰年巳，巳午未年申，申酉戌年亥，亥子丑年寅
+  GuaSu,    // 寡宿：寅卯辰年丑，巳午未年辰，申酉戌年未，亥子丑年戌
+  YueJian,  // 月建
+  YuePo,    // 月破：月建对冲
+  TianDe,   // 天德：正丁二申三壬四辛五亥六甲七癸八寅九丙十乙十一巳十二庚，天干取寄宫
+  YueDe,    // 月德：寅午戌月丙，申子辰月壬，亥卯未月甲，巳酉丑月庚，取寄宫
+  TianXi,   // 天喜：春戌夏丑秋辰冬未
+  ShengQi,  // 生气：月建后二辰
+  SiQi,     // 死气：生气对冲
+  TianMa,   // 天马：正月午，顺行六阳
+  YueYan,   // 月厌：正月戌，逆行十二
+  YouHun,   // 游魂：正月亥，顺行十二
+  XueZhi,   // 血支：月建后一辰
+  XueJi,    // 血忌：正丑二未三寅四申，依次相间顺行
+  RiLu,     // 日禄
+  YangRen,  // 羊刃：日禄前一辰
+  RiDe,     // 日德：甲己寅，乙庚申，丙辛戊癸巳，丁壬亥
+  WenChang, // 文昌
+  TianLuo,  // 天罗：日干寄宫前一辰
+  DiWang,   // 地网：日支前一辰
+  YiMa,     // 驿马
+  TaoHua,   // 桃花（咸池）
+  JieSha,   // 劫煞
+  ZaiSha,   // 灾煞：劫煞前一辰
+  HuaGai,   // 华盖：日支三合之墓
+  XunShou,  // 旬仪：旬首
+  XunYi,    // 旬乙：旬首前一辰
+  DingShen, // 丁神：旬中遁丁
+  XunKong,  // 旬空
+};
+
+inline constexpr int shenShaCount = static_cast<int>(ShenSha::XunKong) + 1;
+
+inline constexpr std::array<std::u8string_view, shenShaCount> shenShaNames = {
+    u8"太岁", u8"岁破", u8"病符", u8"丧门", u8"吊客", u8"岁虎", u8"孤神", u8"寡宿", u8"月建",
+    u8"月破", u8"天德", u8"月德", u8"天喜", u8"生气", u8"死气", u8"天马", u8"月厌", u8"游魂",
+    u8"血支", u8"血忌", u8"日禄", u8"羊刃", u8"日德", u8"文昌", u8"天罗", u8"地网", u8"驿马",
+    u8"桃花", u8"劫煞", u8"灾煞", u8"华盖", u8"旬仪", u8"旬乙", u8"丁神", u8"旬空"};
+
+inline constexpr auto shenShaNameText = makeNameText<shenShaNames>();
+
+constexpr std::u8string_view nameOf(ShenSha sha) {
+  return shenShaNames[static_cast<int>(sha)];
+}
+
+constexpr std::string_view textOf(ShenSha sha) {
+  return shenShaNameText[static_cast<int>(sha)];
+}
+
+// 一宫的神煞集合，第 i 位对应 ShenSha 编号 i
+using ShenShaSet = uint64_t;
+
+// 十二宫的神煞，下标为地支
+using ShenShaPlate = std::array<ShenShaSet, 12>;
+
+static_assert(shenShaCount <= 64);
+
+constexpr bool contains(ShenShaSet set, ShenSha sha) {
+  return (set >> static_cast<int>(sha)) & 1;
+}
+
+// 按编号顺序对集合中的每个神煞调用 f(ShenSha)
+template <class F> constexpr void forEachShenSha(ShenShaSet set, F &&f) {
+  for (; set; set &= set - 1) {
+    f(static_cast<ShenSha>(std::countr_zero(set)));
+  }
+}
+
+namespace shen_sha_detail {
+
+using namespace chart_detail;
+
+// 天德，下标为月支；天干所在取寄宫
+inline constexpr std::array<uint8_t, 12> tianDeOf = {5, 8, 7, 8, 11, 10, 11, 2, 1, 2, 5, 4};
+
+// 文昌，下标为天干
+inline constexpr std::array<uint8_t, 10> wenChangOf = {5, 6, 8, 9, 8, 9, 11, 0, 2, 3};
+
+// 日禄、日德，下标为天干
+inline constexpr std::array<uint8_t, 10> luOf = {2, 3, 5, 6, 5, 6, 8, 9, 11, 0};
+inline constexpr std::array<uint8_t, 10> deOf = {2, 8, 5, 11, 5, 2, 8, 5, 11, 5};
+
+// 月德，下标为月支模 4：申子辰月壬（亥），巳酉丑月庚（申），寅午戌月丙（巳），亥卯未月甲（寅）
+inline constexpr std::array<uint8_t, 4> yueDeOf = {11, 8, 5, 2};
+
+// 三合局的驿马、桃花、劫煞、华盖，下标为地支模 4（申子辰、巳酉丑、寅午戌、亥卯未）
+inline constexpr std::array<uint8_t, 4> horseOf = {2, 11, 8, 5};
+inline constexpr std::array<uint8_t, 4> peachOf = {9, 6, 3, 0};
+inline constexpr std::array<uint8_t, 4> robberyOf = {5, 2, 11, 8};
+inline constexpr std::array<uint8_t, 4> canopyOf = {4, 1, 10, 7};
+
+// 地支所属季节：寅卯辰为 0（春），巳午未 1，申酉戌 2，亥子丑 3
+constexpr int seasonOf(int branch) { return (branch + 10) % 12 / 3; }
+
+struct PlateBuilder {
+  ShenShaPlate plate{};
+
+  constexpr void put(ShenSha sha, int branch) {
+    plate[wrap(branch)] |= ShenShaSet{1} << static_cast<int>(sha);
+  }
+};
+
+constexpr ShenShaPlate yearPlate(int year) {
+  PlateBuilder p;
+  p.put(ShenSha::TaiSui, year);
+  p.put(ShenSha::SuiPo, year + 6);
+  p.put(ShenSha::BingFu, year - 1);
+  p.put(ShenSha::SangMen, year + 2);
+  p.put(ShenSha::DiaoKe, year - 2);
+  p.put(ShenSha::SuiHu, year - 4);
+  p.put(ShenSha::GuChen, 5 + 3 * seasonOf(year));
+  p.put(ShenSha::GuaSu, 1 + 3 * seasonOf(year));
+  return p.plate;
+}
+
+constexpr ShenShaPlate monthPlate(int month) {
+  PlateBuilder p;
+  int order = wrap(month - 2); // 正月（寅）起 0
+  p.put(ShenSha::YueJian, month);
+  p.put(ShenSha::YuePo, month + 6);
+  p.put(ShenSha::TianDe, tianDeOf[month]);
+  p.put(ShenSha::YueDe, yueDeOf[month % 4]);
+  p.put(ShenSha::TianXi, 10 + 3 * seasonOf(month));
+  p.put(ShenSha::ShengQi, month - 2);
+  p.put(ShenSha::SiQi, month + 4);
+  p.put(ShenSha::TianMa, 6 + 2 * order);
+  p.put(ShenSha::YueYan, 10 - order);
+  p.put(ShenSha::YouHun, 11 + order);
+  p.put(ShenSha::XueZhi, month - 1);
+  p.put(ShenSha::XueJi, order % 2 ? 7 + order / 2 : 1 + order / 2);
+  return p.plate;
+}
+
+constexpr ShenShaPlate dayPlate(int stem, int branch) {
+  PlateBuilder p;
+  int xun = wrap(branch - stem);
+  p.put(ShenSha::RiLu, luOf[stem]);
+  p.put(ShenSha::YangRen, luOf[stem] + 1);
+  p.put(ShenSha::RiDe, deOf[stem]);
+  p.put(ShenSha::WenChang, wenChangOf[stem]);
+  p.put(ShenSha::TianLuo, stemPalace(stem) + 1);
+  p.put(ShenSha::DiWang, branch + 1);
+  p.put(ShenSha::YiMa, horseOf[branch % 4]);
+  p.put(ShenSha::TaoHua, peachOf[branch % 4]);
+  p.put(ShenSha::JieSha, robberyOf[branch % 4]);
+  p.put(ShenSha::ZaiSha, robberyOf[branch % 4] + 1);
+  p.put(ShenSha::HuaGai, canopyOf[branch % 4]);
+  p.put(ShenSha::XunShou, xun);
+  p.put(ShenSha::XunYi, xun + 1);
+  p.put(ShenSha::DingShen, xun + 3);
+  p.put(ShenSha::XunKong, xun + 10);
+  p.put(ShenSha::XunKong, xun + 11);
+  return p.plate;
+}
+
+// 按年支、月支、日干支序号预先求出的十二宫神煞
+inline constexpr auto yearPlates = [] {
+  std::array<ShenShaPlate, 12> table{};
+  for (int b = 0; b < 12; ++b) {
+    table[b] = yearPlate(b);
+  }
+  return table;
+}();
+
+inline constexpr auto monthPlates = [] {
+  std::array<ShenShaPlate, 12> table{};
+  for (int b = 0; b < 12; ++b) {
+    table[b] = monthPlate(b);
+  }
+  return table;
+}();
+
+inline constexpr auto dayPlates = [] {
+  std::array<ShenShaPlate, 60> table{};
+  for (int i = 0; i < 60; ++i) {
+    table[i] = dayPlate(i % 10, i % 12);
+  }
+  return table;
+}();
+
+} // namespace shen_sha_detail
+
+// 由太岁、月建与日柱求十二宫神煞
+constexpr ShenShaPlate computeShenSha(EarthlyBranch year, EarthlyBranch month, Pillar day) {
+  using namespace shen_sha_detail;
+  const ShenShaPlate &y = yearPlates[static_cast<int>(year)];
+  const ShenShaPlate &m = monthPlates[static_cast<int>(month)];
+  const ShenShaPlate &d = dayPlates[pillarIndex(day)];
+  ShenShaPlate plate;
+  for (int b = 0; b < 12; ++b) {
+    plate[b] = y[b] | m[b] | d[b];
+  }
+  return plate;
+}
+
+constexpr ShenShaPlate computeShenSha(const FourPillars &pillars) {
+  return computeShenSha(pillars.year.branch, pillars.month.branch, pillars.day);
+}
+
+// 单宫的神煞，只取三张表的一行
+constexpr ShenShaSet computeShenSha(const FourPillars &pillars, EarthlyBranch branch) {
+  using namespace shen_sha_detail;
+  int b = static_cast<int>(branch);
+  return yearPlates[static_cast<int>(pillars.year.branch)][b] |
+         monthPlates[static_cast<int>(pillars.month.branch)][b] |
+         dayPlates[pillarIndex(pillars.day)][b];
+}
+
+static_assert(contains(computeShenSha(EarthlyBranch::Chen, EarthlyBranch::Yin,
+                                      {HeavenlyStem::Jia, EarthlyBranch::Zi})[7],
+                       ShenSha::TianDe));
+static_assert(contains(computeShenSha(EarthlyBranch::Chen, EarthlyBranch::Yin,
+                                      {HeavenlyStem::Jia, EarthlyBranch::Zi})[10],
+                       ShenSha::XunKong));
+static_assert(contains(computeShenSha(EarthlyBranch::Chen, EarthlyBranch::Wu,
+                                      {HeavenlyStem::Yi, EarthlyBranch::Si})[5],
+                       ShenSha::YueDe));
+
+#endif // DA_LIU_REN_SHEN_SHA_HPP
@@ -0,0 +1,106 @@
+//
+// 工作窃取：把 [0, chunks) 个任务块分给若干线程，闲下来的线程从别人的区间尾部窃取一半
+//
+
+#ifndef DA_LIU_REN_WORK_STEALING_HPP
+#define DA_LIU_REN_WORK_STEALING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace work_stealing_detail {
+
+// 一个线程待处理的块区间 [lo, hi)，打包进一个 64 位原子量，取、窃都是一次 CAS
+struct alignas(64) Range {
+  std::atomic<uint64_t> bounds{0};
+
+  static constexpr uint64_t pack(uint32_t lo, uint32_t hi) {
+    return static_cast<uint64_t>(hi) << 32 | lo;
+  }
+
+  // 本线程从头部取一块
+  bool pop(uint32_t &chunk) {
+    uint64_t b = bounds.load(std::memory_order_acquire);
+    for (;;) {
+      uint32_t lo = static_cast<uint32_t>(b), hi = static_cast<uint32_t>(b >> 32);
+      if (lo >= hi) {
+        return false;
+      }
+      if (bounds.compare_exchange_weak(b, pack(lo + 1, hi), std::memory_order_acq_rel)) {
+        chunk = lo;
+        return true;
+      }
+    }
+  }
+
+  // 从尾部窃取一半，得到 [lo, hi)
+  bool steal(uint32_t &lo, uint32_t &hi) {
+    uint64_t b = bounds.load(std::memory_order_acquire);
+    for (;;) {
+      uint32_t from = static_cast<uint32_t>(b), to = static_cast<uint32_t>(b >> 32);
+      if (from >= to) {
+        return false;
+      }
+      uint32_t mid = to - (to - from + 1) / 2;
+      if (bounds.compare_exchange_weak(b, pack(from, mid), std::memory_order_acq_rel)) {
+        lo = mid;
+        hi = to;
+        return true;
+      }
+    }
+  }
+};
+
+} // namespace work_stealing_detail
+
+// 以 threads 个线程（0 取硬件并发数）处理 chunks 个块，对每块调用 fn(worker, chunk)。
+// worker 为 0~threads-1 的线程编号，可用于索引各线程自己的局部结果；调用线程充当 0 号
+template <class Fn>
+void forEachChunk(std::size_t chunks, unsigned threads, Fn &&fn) {
+  using work_stealing_detail::Range;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(chunks, 1)));
+  std::vector<Range> ranges(threads);
+  for (unsigned w = 0; w < threads; ++w) {
+    ranges[w].bounds.store(Range::pack(static_cast<uint32_t>(chunks * w / threads),
+                                       static_cast<uint32_t>(chunks * (w + 1) / threads)));
+  }
+
+  auto run = [&](unsigned worker) {
+    Range &own = ranges[worker];
+    for (;;) {
+      uint32_t chunk;
+      while (own.pop(chunk)) {
+        fn(worker, static_cast<std::size_t>(chunk));
+      }
+      // 自己的区间已空，依次向其他线程窃取；一轮都窃不到即结束
+      bool stolen = false;
+      for (unsigned k = 1; k < threads && !stolen; ++k) {
+        uint32_t lo, hi;
+        if (ranges[(worker + k) % threads].steal(lo, hi)) {
+          own.bounds.store(Range::pack(lo + 1, hi), std::memory_order_release);
+          fn(worker, static_cast<std::size_t>(lo));
+          stolen = true;
+        }
+      }
+      if (!stolen) {
+        return;
+      }
+    }
+  };
+
+  std::vector<std::jthread> workers;
+  workers.reserve(threads - 1);
+  for (unsigned w = 1; w < threads; ++w) {
+    workers.emplace_back(run, w);
+  }
+  run(0);
+}
+
+#endif // DA_LIU_REN_WORK_STEALING_HPP